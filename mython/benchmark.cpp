@@ -0,0 +1,156 @@
+#include "benchmark.h"
+
+#include "lexer.h"
+#include "optimize.h"
+#include "parse.h"
+#include "runtime.h"
+#include "statement.h"
+#include "vm.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace benchmark {
+
+namespace {
+
+constexpr int WARMUP_RUNS = 3;
+constexpr int MEASURED_RUNS = 7;
+
+// Выполняет action после прогрева MEASURED_RUNS раз и возвращает лучшее
+// время одной операции в наносекундах. Параметр ops_per_run задаёт число
+// операций, выполняемых одним вызовом action
+double MeasureNsPerOp(int64_t ops_per_run, const function<void()>& action) {
+    using namespace chrono;
+
+    for (int i = 0; i < WARMUP_RUNS; ++i) {
+        action();
+    }
+
+    double best_ns = numeric_limits<double>::max();
+    for (int i = 0; i < MEASURED_RUNS; ++i) {
+        const auto start = steady_clock::now();
+        action();
+        const auto elapsed = duration_cast<nanoseconds>(steady_clock::now() - start);
+        best_ns = min(best_ns, static_cast<double>(elapsed.count())
+                                   / static_cast<double>(ops_per_run));
+    }
+    return best_ns;
+}
+
+void Report(ostream& os, const string& name, const string& unit, double ns_per_op) {
+    os << left << setw(24) << name << right << setw(12) << fixed << setprecision(1) << ns_per_op
+       << " ns/" << unit << setw(14) << setprecision(0) << 1e9 / ns_per_op << ' ' << unit
+       << "/s" << '\n';
+}
+
+// Возвращает текст программы из line_count одинаковых строк line
+string RepeatLine(const string& line, int line_count) {
+    string program;
+    program.reserve(line.size() * static_cast<size_t>(line_count));
+    for (int i = 0; i < line_count; ++i) {
+        program += line;
+    }
+    return program;
+}
+
+// Пропускная способность лексера: разбор токенов до Eof
+void BenchmarkLexer(ostream& os) {
+    const string program = RepeatLine("x = x + y * 2 - height / width\n"s, 1000);
+
+    int64_t token_count = 0;
+    {
+        istringstream is(program);
+        parse::Lexer lexer(is);
+        while (!lexer.CurrentToken().Is<parse::token_type::Eof>()) {
+            lexer.NextToken();
+            ++token_count;
+        }
+    }
+
+    const double ns = MeasureNsPerOp(token_count, [&program] {
+        istringstream is(program);
+        parse::Lexer lexer(is);
+        while (!lexer.CurrentToken().Is<parse::token_type::Eof>()) {
+            lexer.NextToken();
+        }
+    });
+    Report(os, "Lexer"s, "token"s, ns);
+}
+
+// Скорость построения дерева программы парсером
+void BenchmarkParser(ostream& os) {
+    const int statement_count = 1000;
+    const string program = RepeatLine("x = x + y * 2 - height / width\n"s, statement_count);
+
+    const double ns = MeasureNsPerOp(statement_count, [&program] {
+        istringstream is(program);
+        parse::Lexer lexer(is);
+        auto tree = ParseProgram(lexer);
+    });
+    Report(os, "Parser"s, "stmt"s, ns);
+}
+
+// Частота вызовов метода через ClassInstance::Call
+void BenchmarkMethodCalls(ostream& os) {
+    vector<runtime::Method> methods;
+    methods.push_back(runtime::Method{
+        "value"s, {},
+        make_unique<ast::MethodBody>(
+            make_unique<ast::Return>(make_unique<ast::NumericConst>(runtime::Number{42})))});
+    runtime::Class cls{"Benchmark"s, std::move(methods), nullptr};
+    runtime::ClassInstance instance{cls};
+    runtime::DummyContext context;
+
+    const int64_t calls_per_run = 100'000;
+    const double ns = MeasureNsPerOp(calls_per_run, [&instance, &context] {
+        static const runtime::Symbol VALUE{"value"};
+        for (int64_t i = 0; i < 100'000; ++i) {
+            instance.Call(VALUE, {}, context);
+        }
+    });
+    Report(os, "MethodCall"s, "call"s, ns);
+}
+
+// Полный путь выполнения: лексер, парсер, оптимизатор, компиляция, выполнение
+void BenchmarkEndToEnd(ostream& os) {
+    const string program = RepeatLine("x = 3 + 4 * 5\ny = x - 1\n"s, 200)
+                           + "print x, y\n"s;
+
+    const double ns = MeasureNsPerOp(1, [&program] {
+        runtime::ObjectArena arena;
+        runtime::ObjectArena::Scope arena_scope{arena};
+
+        istringstream is(program);
+        parse::Lexer lexer(is);
+        auto compiled = vm::Compile(ast::Optimize(ParseProgram(lexer)));
+
+        ostringstream output;
+        runtime::SimpleContext context{output};
+        runtime::Closure closure;
+        compiled->Execute(closure, context);
+    });
+    Report(os, "EndToEnd"s, "run"s, ns);
+}
+
+}  // namespace
+
+void RunBenchmarks(ostream& os) {
+    BenchmarkLexer(os);
+    BenchmarkParser(os);
+    BenchmarkMethodCalls(os);
+    BenchmarkEndToEnd(os);
+}
+
+}  // namespace benchmark
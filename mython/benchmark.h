@@ -0,0 +1,17 @@
+#pragma once
+
+#include <iosfwd>
+
+namespace benchmark {
+
+/*
+ * Выполняет набор микробенчмарков интерпретатора и выводит результаты в os:
+ * пропускную способность лексера (нс/токен), разбора (нс/инструкцию),
+ * вызовов методов (нс/вызов) и полного выполнения программы (нс/запуск).
+ *
+ * Каждый замер повторяется несколько раз после прогрева, берётся лучшее
+ * время - так результат меньше зависит от шума планировщика
+ */
+void RunBenchmarks(std::ostream& os);
+
+}  // namespace benchmark
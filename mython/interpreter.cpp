@@ -0,0 +1,171 @@
+#include "interpreter.h"
+
+#include "lexer.h"
+#include "optimize.h"
+#include "parse.h"
+#include "vm.h"
+
+#include <sstream>
+#include <utility>
+
+using namespace std;
+
+namespace interpreter {
+
+void Interpreter::Run(istream& input, ostream& output) {
+    {
+        runtime::ObjectArena::Scope arena_scope{arena_};
+
+        parse::Lexer lexer(input);
+        // Тела методов разбираются отложенно: типичная программа вызывает
+        // лишь малую часть методов, и разбор остальных не задерживает запуск
+        auto program = vm::Compile(ast::Optimize(ParseProgram(lexer, ParseMode::Lazy)));
+
+        runtime::SimpleContext context{output};
+        {
+            runtime::Closure closure;
+            if (!native_methods_.empty() || builtins_ != nullptr) {
+                InstallBuiltins(closure);
+            }
+            program->Execute(closure, context);
+        }
+        // Таблица имён разрушена: всё, что осталось живым, удерживается
+        // только циклами ссылок. Циклы разрываются, чтобы деструкторы
+        // экземпляров освободили память вне арены (таблицы полей, строки)
+        runtime::CycleCollector::CollectCycles({});
+    }
+    // Программа завершена, её объекты больше не нужны -
+    // память арены освобождается разом
+    arena_.Reset();
+}
+
+void Interpreter::RegisterNative(string name, vector<string> formal_params,
+                                 runtime::NativeFunction fn) {
+    runtime::Method method;
+    method.name = std::move(name);
+    method.formal_params.reserve(formal_params.size());
+    for (const auto& param : formal_params) {
+        method.formal_params.push_back(runtime::Symbol{param});
+    }
+    method.native = std::move(fn);
+    native_methods_.push_back(std::move(method));
+}
+
+void Interpreter::InstallBuiltins(runtime::Closure& closure) {
+    if (!native_methods_.empty()) {
+        builtins_ = make_shared<runtime::Class>("builtins"s, std::move(native_methods_), nullptr);
+        native_methods_.clear();
+    }
+    static const runtime::Symbol BUILTINS{"builtins"};
+    closure[BUILTINS] = runtime::ObjectHolder::Own(runtime::ClassInstance{*builtins_});
+}
+
+ProgramSnapshot::ProgramSnapshot(const string& source) {
+    // Снимок разбирается без арены: классы и тела методов должны жить,
+    // пока жив сам снимок, а не до конца первого запуска
+    istringstream input{source};
+    parse::Lexer lexer(input);
+    program_ = vm::Compile(ast::Optimize(ParseProgram(lexer)));
+}
+
+ProgramSnapshot::~ProgramSnapshot() = default;
+
+RunResult ProgramSnapshot::Run() const {
+    RunResult run_result;
+    try {
+        // Каждый запуск получает собственную арену и таблицу имён,
+        // поэтому запуски не видят друг друга
+        runtime::ObjectArena arena;
+        runtime::ObjectArena::Scope arena_scope{arena};
+
+        ostringstream output;
+        {
+            runtime::SimpleContext context{output};
+            runtime::Closure closure;
+            program_->Execute(closure, context);
+        }
+        // Разрываем циклы ссылок, пережившие таблицу имён запуска,
+        // прежде чем будет освобождена память арены
+        runtime::CycleCollector::CollectCycles({});
+        run_result.output = output.str();
+    } catch (const exception& e) {
+        run_result.error = e.what();
+    }
+    return run_result;
+}
+
+ScriptRunner::ScriptRunner(size_t thread_count) {
+    workers_.reserve(thread_count);
+    for (size_t i = 0; i < thread_count; ++i) {
+        workers_.emplace_back([this] { WorkerLoop(); });
+    }
+}
+
+ScriptRunner::~ScriptRunner() {
+    {
+        lock_guard guard{mutex_};
+        stopping_ = true;
+    }
+    has_work_.notify_all();
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+future<RunResult> ScriptRunner::Submit(string source) {
+    Task task{std::move(source), {}};
+    auto result = task.result.get_future();
+    {
+        lock_guard guard{mutex_};
+        tasks_.push_back(std::move(task));
+    }
+    has_work_.notify_one();
+    return result;
+}
+
+void ScriptRunner::WorkerLoop() {
+    for (;;) {
+        Task task;
+        {
+            unique_lock lock{mutex_};
+            has_work_.wait(lock, [this] { return !tasks_.empty() || stopping_; });
+            if (tasks_.empty()) {
+                // stopping_ установлен, а работы не осталось
+                return;
+            }
+            task = std::move(tasks_.front());
+            tasks_.pop_front();
+        }
+
+        RunResult run_result;
+        try {
+            Interpreter isolate;
+            istringstream input{std::move(task.source)};
+            ostringstream output;
+            isolate.Run(input, output);
+            run_result.output = output.str();
+        } catch (const exception& e) {
+            run_result.error = e.what();
+        }
+        task.result.set_value(std::move(run_result));
+    }
+}
+
+vector<RunResult> RunParallel(const vector<string>& sources, size_t thread_count) {
+    vector<future<RunResult>> futures;
+    futures.reserve(sources.size());
+
+    ScriptRunner runner{thread_count};
+    for (const auto& source : sources) {
+        futures.push_back(runner.Submit(source));
+    }
+
+    vector<RunResult> results;
+    results.reserve(sources.size());
+    for (auto& result : futures) {
+        results.push_back(result.get());
+    }
+    return results;
+}
+
+}  // namespace interpreter
@@ -0,0 +1,129 @@
+#pragma once
+
+#include "runtime.h"
+
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <iosfwd>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace vm {
+class Program;
+}  // namespace vm
+
+namespace interpreter {
+
+/*
+ * Изолят интерпретатора: объединяет лексер, парсер и состояние выполнения
+ * одной программы. Экземпляры не разделяют изменяемого состояния, поэтому
+ * независимые программы можно выполнять в разных потоках одновременно
+ * (общая таблица символов защищена мьютексом и только растёт).
+ *
+ * Память объектов программы выделяется из арены изолята и освобождается
+ * разом по завершении Run
+ */
+class Interpreter {
+public:
+    Interpreter() = default;
+    Interpreter(const Interpreter&) = delete;
+    Interpreter& operator=(const Interpreter&) = delete;
+
+    // Выполняет программу из input, направляя вывод команд print в output
+    void Run(std::istream& input, std::ostream& output);
+
+    /*
+     * Регистрирует нативную (C++) функцию fn, доступную скриптам как метод
+     * встроенного объекта builtins: builtins.name(arg1, ...).
+     * Количество имён в formal_params задаёт арность метода.
+     * Регистрировать методы допустимо только до первого вызова Run
+     */
+    void RegisterNative(std::string name, std::vector<std::string> formal_params,
+                        runtime::NativeFunction fn);
+
+private:
+    // Помещает в closure объект builtins с зарегистрированными методами
+    void InstallBuiltins(runtime::Closure& closure);
+
+    runtime::ObjectArena arena_;
+    // Нативные методы, зарегистрированные до первого запуска
+    std::vector<runtime::Method> native_methods_;
+    // Класс объекта builtins; создаётся при первом Run и переживает запуски,
+    // так как методы адресуются указателями внутрь класса
+    std::shared_ptr<runtime::Class> builtins_;
+};
+
+// Результат выполнения программы пулом потоков
+struct RunResult {
+    // Вывод команд print программы
+    std::string output;
+    // Сообщение об ошибке либо пустая строка, если программа выполнена успешно
+    std::string error;
+};
+
+/*
+ * Прогретый снимок один раз разобранной программы. Снимок держит
+ * неизменяемый образ программы - классы, тела методов и байт-код, -
+ * а каждое выполнение получает собственные таблицу имён верхнего уровня,
+ * арену и контекст. Благодаря этому один снимок можно выполнять
+ * из нескольких потоков одновременно, не платя за разбор и компиляцию
+ * на каждый запуск
+ */
+class ProgramSnapshot {
+public:
+    // Разбирает, оптимизирует и компилирует программу source
+    explicit ProgramSnapshot(const std::string& source);
+    ProgramSnapshot(const ProgramSnapshot&) = delete;
+    ProgramSnapshot& operator=(const ProgramSnapshot&) = delete;
+    ~ProgramSnapshot();
+
+    // Выполняет программу в собственном состоянии запуска.
+    // Допустимо вызывать из нескольких потоков одновременно
+    RunResult Run() const;
+
+private:
+    std::unique_ptr<vm::Program> program_;
+};
+
+/*
+ * Пул потоков для параллельного выполнения независимых Mython-программ
+ * в одном процессе. Каждая программа выполняется собственным изолятом,
+ * поэтому программы не влияют друг на друга
+ */
+class ScriptRunner {
+public:
+    explicit ScriptRunner(size_t thread_count);
+    ScriptRunner(const ScriptRunner&) = delete;
+    ScriptRunner& operator=(const ScriptRunner&) = delete;
+    // Дожидается завершения всех принятых программ
+    ~ScriptRunner();
+
+    // Ставит текст программы в очередь на выполнение.
+    // Результат доступен через возвращённый future
+    std::future<RunResult> Submit(std::string source);
+
+private:
+    struct Task {
+        std::string source;
+        std::promise<RunResult> result;
+    };
+
+    // Цикл рабочего потока: берёт программы из очереди и выполняет их
+    void WorkerLoop();
+
+    std::mutex mutex_;
+    std::condition_variable has_work_;
+    std::deque<Task> tasks_;
+    bool stopping_ = false;
+    std::vector<std::thread> workers_;
+};
+
+// Выполняет sources на thread_count потоках и возвращает результаты
+// в порядке исходных программ
+std::vector<RunResult> RunParallel(const std::vector<std::string>& sources, size_t thread_count);
+
+}  // namespace interpreter
@@ -0,0 +1,192 @@
+#include "interpreter.h"
+
+#include "test_runner_p.h"
+
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+namespace interpreter {
+
+void TestIsolatesAreIndependent() {
+    // Одноимённые классы в разных изолятах не мешают друг другу
+    const string first = R"(
+class Greeter:
+  def greeting():
+    return 'hello'
+
+g = Greeter()
+print g.greeting()
+)"s;
+    const string second = R"(
+class Greeter:
+  def greeting():
+    return 'goodbye'
+
+g = Greeter()
+print g.greeting()
+)"s;
+
+    Interpreter isolate_1;
+    Interpreter isolate_2;
+
+    istringstream input_1{first};
+    ostringstream output_1;
+    isolate_1.Run(input_1, output_1);
+
+    istringstream input_2{second};
+    ostringstream output_2;
+    isolate_2.Run(input_2, output_2);
+
+    ASSERT_EQUAL(output_1.str(), "hello\n"s);
+    ASSERT_EQUAL(output_2.str(), "goodbye\n"s);
+}
+
+void TestInterpreterIsReusable() {
+    Interpreter isolate;
+    for (int i = 0; i < 3; ++i) {
+        istringstream input{"x = 2 + 2\nprint x, 'and', x * x\n"s};
+        ostringstream output;
+        isolate.Run(input, output);
+        ASSERT_EQUAL(output.str(), "4 and 16\n"s);
+    }
+}
+
+void TestParallelScripts() {
+    vector<string> sources;
+    vector<string> expected;
+    for (int i = 0; i < 20; ++i) {
+        sources.push_back("x = "s + to_string(i) + "\nprint x + x\n"s);
+        expected.push_back(to_string(i + i) + "\n"s);
+    }
+    // Программа с ошибкой не должна влиять на соседние
+    sources.push_back("x = 1 / 0\n"s);
+
+    const auto results = RunParallel(sources, 4);
+    ASSERT_EQUAL(results.size(), sources.size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+        ASSERT_EQUAL(results[i].output, expected[i]);
+        ASSERT(results[i].error.empty());
+    }
+    ASSERT(!results.back().error.empty());
+}
+
+void TestSnapshotIsReusable() {
+    const string source = R"(
+class Counter:
+  def __init__():
+    self.value = 0
+
+  def add(d):
+    self.value = self.value + d
+
+c = Counter()
+i = 0
+while i < 5:
+  c.add(i)
+  i = i + 1
+
+print c.value
+)"s;
+
+    ProgramSnapshot snapshot{source};
+    // Повторные запуски независимы: классы объявляются заново,
+    // а экземпляры создаются с чистыми полями
+    for (int i = 0; i < 3; ++i) {
+        const auto result = snapshot.Run();
+        ASSERT_EQUAL(result.error, ""s);
+        ASSERT_EQUAL(result.output, "10\n"s);
+    }
+}
+
+void TestSnapshotIsSharedAcrossThreads() {
+    const string source = R"(
+class Accumulator:
+  def __init__(start):
+    self.total = start
+
+  def add(d):
+    self.total = self.total + d
+
+a = Accumulator(1)
+i = 0
+while i < 100:
+  a.add(i)
+  i = i + 1
+
+print a.total
+)"s;
+
+    ProgramSnapshot snapshot{source};
+
+    // Один снимок одновременно обслуживает несколько потоков
+    const size_t thread_count = 4;
+    vector<RunResult> results(thread_count);
+    vector<thread> threads;
+    threads.reserve(thread_count);
+    for (size_t i = 0; i < thread_count; ++i) {
+        threads.emplace_back([&snapshot, &results, i] {
+            for (int run = 0; run < 25; ++run) {
+                results[i] = snapshot.Run();
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    for (const auto& result : results) {
+        ASSERT_EQUAL(result.error, ""s);
+        ASSERT_EQUAL(result.output, "4951\n"s);
+    }
+}
+
+void TestNativeBuiltins() {
+    Interpreter isolate;
+    // Сумма кодов символов строки - типичная "горячая" функция,
+    // которую выгодно перенести из Mython в C++
+    isolate.RegisterNative("checksum"s, {"text"s},
+                           [](runtime::ClassInstance& /*self*/, const runtime::ObjectHolder* args,
+                              size_t count, runtime::Context& /*context*/) {
+                               ASSERT_EQUAL(count, 1U);
+                               int sum = 0;
+                               for (const char c : args[0].TryAs<runtime::String>()->GetValue()) {
+                                   sum += c;
+                               }
+                               return runtime::ObjectHolder::Own(runtime::Number{sum});
+                           });
+    isolate.RegisterNative("clamp"s, {"value"s, "low"s, "high"s},
+                           [](runtime::ClassInstance& /*self*/, const runtime::ObjectHolder* args,
+                              size_t /*count*/, runtime::Context& /*context*/) {
+                               const int value = args[0].TryAs<runtime::Number>()->GetValue();
+                               const int low = args[1].TryAs<runtime::Number>()->GetValue();
+                               const int high = args[2].TryAs<runtime::Number>()->GetValue();
+                               return runtime::ObjectHolder::Own(
+                                   runtime::Number{min(max(value, low), high)});
+                           });
+
+    // Нативные методы доступны и повторным запускам того же изолята
+    for (int i = 0; i < 2; ++i) {
+        istringstream input{R"(
+print builtins.checksum('ab')
+print builtins.clamp(42, 0, 10)
+)"s};
+        ostringstream output;
+        isolate.Run(input, output);
+        ASSERT_EQUAL(output.str(), "195\n10\n"s);
+    }
+}
+
+void RunInterpreterTests(TestRunner& tr) {
+    RUN_TEST(tr, interpreter::TestIsolatesAreIndependent);
+    RUN_TEST(tr, interpreter::TestInterpreterIsReusable);
+    RUN_TEST(tr, interpreter::TestParallelScripts);
+    RUN_TEST(tr, interpreter::TestSnapshotIsReusable);
+    RUN_TEST(tr, interpreter::TestSnapshotIsSharedAcrossThreads);
+    RUN_TEST(tr, interpreter::TestNativeBuiltins);
+}
+
+}  // namespace interpreter
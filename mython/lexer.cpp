@@ -2,12 +2,78 @@
 
 #include <algorithm>
 #include <charconv>
+#include <optional>
+#include <string_view>
 #include <unordered_map>
 
 using namespace std;
 
 namespace parse {
 
+namespace {
+
+// Распознаёт ключевое слово без таблицы в памяти: ветвление по длине
+// отсекает большинство идентификаторов, затем достаточно одного сравнения
+// байтов на кандидата. Таблица общая для всех экземпляров Lexer
+optional<Token> MatchKeyword(string_view id) {
+    switch (id.size()) {
+        case 2:
+            if (id == "if"sv) {
+                return token_type::If{};
+            }
+            if (id == "or"sv) {
+                return token_type::Or{};
+            }
+            break;
+        case 3:
+            if (id == "def"sv) {
+                return token_type::Def{};
+            }
+            if (id == "and"sv) {
+                return token_type::And{};
+            }
+            if (id == "not"sv) {
+                return token_type::Not{};
+            }
+            break;
+        case 4:
+            if (id == "else"sv) {
+                return token_type::Else{};
+            }
+            if (id == "None"sv) {
+                return token_type::None{};
+            }
+            if (id == "True"sv) {
+                return token_type::True{};
+            }
+            break;
+        case 5:
+            if (id == "class"sv) {
+                return token_type::Class{};
+            }
+            if (id == "print"sv) {
+                return token_type::Print{};
+            }
+            if (id == "False"sv) {
+                return token_type::False{};
+            }
+            if (id == "while"sv) {
+                return token_type::While{};
+            }
+            break;
+        case 6:
+            if (id == "return"sv) {
+                return token_type::Return{};
+            }
+            break;
+        default:
+            break;
+    }
+    return nullopt;
+}
+
+}  // namespace
+
 bool operator==(const Token& lhs, const Token& rhs) {
     using namespace token_type;
 
@@ -68,6 +134,7 @@ std::ostream& operator<<(std::ostream& os, const Token& rhs) {
     UNVALUED_OUTPUT(None);
     UNVALUED_OUTPUT(True);
     UNVALUED_OUTPUT(False);
+    UNVALUED_OUTPUT(While);
     UNVALUED_OUTPUT(Eof);
 
 #undef UNVALUED_OUTPUT
@@ -77,45 +144,74 @@ std::ostream& operator<<(std::ostream& os, const Token& rhs) {
     
 constexpr int INDENT_SPACES_COUNT = 2;    
 
-Lexer::Lexer(std::istream& input): input_(input) {
-    ParseTokens(input);
+Lexer::Lexer(std::istream& input): input_(&input) {
+    current_token_ = FetchNextToken();
+}
+
+Lexer::Lexer(std::vector<Token> tokens) {
+    for (auto& token : tokens) {
+        pending_.push_back(std::move(token));
+    }
+    eof_emitted_ = true;
+    current_token_ = FetchNextToken();
 }
 
 const Token& Lexer::CurrentToken() const {
-    return *current_token_;
+    return current_token_;
 }
 
-Token Lexer::NextToken() {
-    if ((current_token_ + 1) == tokens_.end()) {
-        return token_type::Eof{};
+const Token& Lexer::NextToken() {
+    if (current_token_.Is<token_type::Eof>()) {
+        return current_token_;
     }
-    return *++current_token_;
+    current_token_ = FetchNextToken();
+    return current_token_;
 }
-    
-void Lexer::ParseTokens(std::istream& input) {
-    tokens_.clear();
-    current_token_ = tokens_.begin();
-    
+
+Token Lexer::FetchNextToken() {
+    if (pending_.empty()) {
+        TokenizeNext();
+    }
+    Token token = std::move(pending_.front());
+    pending_.pop_front();
+    return token;
+}
+
+void Lexer::TokenizeNext() {
     char current_char;
-    while (input.get(current_char)) {
-        input.putback(current_char);
+    while (input_ != nullptr && pending_.empty() && input_->get(current_char)) {
+        input_->putback(current_char);
 
-        ParseNewLine(input);
-        ParseStrings(input);
-        ParseId(input);
-        ParseComparisonOperators(input);
-        ParseChar(input);
-        ParseNumbers(input);
+        ParseNewLine(*input_);
+        ParseStrings(*input_);
+        ParseId(*input_);
+        ParseComparisonOperators(*input_);
+        ParseChar(*input_);
+        ParseNumbers(*input_);
 
-        SkipSpaces(input);
+        SkipSpaces(*input_);
     }
-    
-    if (!tokens_.empty() && tokens_.back() != token_type::Newline{} && tokens_.back() != token_type::Dedent{}) {
-        tokens_.emplace_back(token_type::Newline{});
+
+    if (pending_.empty()) {
+        // Ввод исчерпан: непустая программа завершается токеном Newline,
+        // затем до бесконечности выдаётся Eof
+        if (!eof_emitted_ && last_emitted_ == LastEmitted::Other) {
+            Emit(token_type::Newline{});
+        }
+        eof_emitted_ = true;
+        Emit(token_type::Eof{});
     }
-    
-    tokens_.emplace_back(token_type::Eof{});
-    current_token_ = tokens_.begin();
+}
+
+void Lexer::Emit(Token token) {
+    if (token.Is<token_type::Newline>()) {
+        last_emitted_ = LastEmitted::Newline;
+    } else if (token.Is<token_type::Dedent>()) {
+        last_emitted_ = LastEmitted::Dedent;
+    } else {
+        last_emitted_ = LastEmitted::Other;
+    }
+    pending_.push_back(std::move(token));
 }
 
 void Lexer::ParseChar(std::istream& input) {
@@ -128,7 +224,7 @@ void Lexer::ParseChar(std::istream& input) {
             return;
         }
         input.get(current_char);
-        tokens_.emplace_back(token_type::Char{ current_char });
+        Emit(token_type::Char{ current_char });
     }
 }
     
@@ -138,16 +234,16 @@ void Lexer::ParseComparisonOperators(std::istream& input) {
     char next_char = input.peek();
     if (current_char == '=' && next_char == '=') {
         input.get();
-        tokens_.emplace_back(token_type::Eq{});
+        Emit(token_type::Eq{});
     } else if (current_char == '>' && next_char == '=') {
         input.get();
-        tokens_.emplace_back(token_type::GreaterOrEq{});
+        Emit(token_type::GreaterOrEq{});
     } else if (current_char == '<' && next_char == '=') {
         input.get();
-        tokens_.emplace_back(token_type::LessOrEq{});
+        Emit(token_type::LessOrEq{});
     } else if (current_char == '!' && next_char == '=') {
         input.get();
-        tokens_.emplace_back(token_type::NotEq{});
+        Emit(token_type::NotEq{});
     } else {
         input.putback(current_char);
     }
@@ -158,8 +254,8 @@ void Lexer::ParseNewLine(std::istream& input) {
     input.get(current_char);
 
     if (current_char == '\n') {
-        if (!tokens_.empty() && tokens_.back() != token_type::Newline{}) {
-            tokens_.emplace_back(token_type::Newline{});
+        if (last_emitted_ != LastEmitted::None && last_emitted_ != LastEmitted::Newline) {
+            Emit(token_type::Newline{});
         }
         ParseIndent(input);
     } else {
@@ -196,7 +292,7 @@ void Lexer::ParseIndent(std::istream& input) {
     }
     
     for (int i = 0; i < std::abs(indents_count); ++i) {
-        tokens_.emplace_back(indent_type);
+        Emit(indent_type);
     }
 }
     
@@ -242,7 +338,7 @@ void Lexer::ParseStrings(std::istream& input) {
                 str.push_back(current_char);
             }
         }
-        tokens_.emplace_back(token_type::String{ str });
+        Emit(token_type::String{ std::move(str) });
     } else {
         input.putback(open_char);
     }
@@ -262,7 +358,7 @@ void Lexer::ParseNumbers(std::istream& input) {
             }
         }
         int result_num = std::stoi(num);
-        tokens_.emplace_back(token_type::Number{ result_num });
+        Emit(token_type::Number{ result_num });
     }
 }
     
@@ -280,10 +376,10 @@ void Lexer::ParseId(std::istream& input) {
             }
         }
         
-        if (keywords_.find(id) != keywords_.end()) {
-            tokens_.push_back(keywords_.at(id));
+        if (auto keyword = MatchKeyword(id)) {
+            Emit(*keyword);
         } else {
-            tokens_.emplace_back(token_type::Id{id});
+            Emit(token_type::Id{ std::move(id) });
         }
     }
 }
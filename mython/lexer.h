@@ -1,12 +1,12 @@
 #pragma once
 
+#include <deque>
 #include <iosfwd>
 #include <optional>
 #include <sstream>
 #include <stdexcept>
 #include <string>
 #include <variant>
-#include <map>
 #include <vector>
 
 namespace parse {
@@ -48,6 +48,7 @@ struct GreaterOrEq {};  // Лексема «>=»
 struct None {};         // Лексема «None»
 struct True {};         // Лексема «True»
 struct False {};        // Лексема «False»
+struct While {};        // Лексема «while»
 }  // namespace token_type
 
 using TokenBase
@@ -56,7 +57,8 @@ using TokenBase
                    token_type::Def, token_type::Newline, token_type::Print, token_type::Indent,
                    token_type::Dedent, token_type::And, token_type::Or, token_type::Not,
                    token_type::Eq, token_type::NotEq, token_type::LessOrEq, token_type::GreaterOrEq,
-                   token_type::None, token_type::True, token_type::False, token_type::Eof>;
+                   token_type::None, token_type::True, token_type::False, token_type::While,
+                   token_type::Eof>;
 
 struct Token : TokenBase {
     using TokenBase::TokenBase;
@@ -91,11 +93,18 @@ class Lexer {
 public:
     explicit Lexer(std::istream& input);
 
+    // Создаёт лексер, выдающий заранее разобранные токены tokens,
+    // а после их исчерпания - token_type::Eof. Используется
+    // при отложенном разборе тел методов
+    explicit Lexer(std::vector<Token> tokens);
+
     // Возвращает ссылку на текущий токен или token_type::Eof, если поток токенов закончился
     [[nodiscard]] const Token& CurrentToken() const;
 
-    // Возвращает следующий токен, либо token_type::Eof, если поток токенов закончился
-    Token NextToken();
+    // Переходит к следующему токену и возвращает ссылку на него,
+    // либо на token_type::Eof, если поток токенов закончился.
+    // Ссылка действительна до следующего вызова NextToken
+    const Token& NextToken();
 
     // Если текущий токен имеет тип T, метод возвращает ссылку на него.
     // В противном случае метод выбрасывает исключение LexerError
@@ -133,27 +142,34 @@ public:
     }
 
 private:
-    std::map<std::string, Token> keywords_ {
-		{ "class",  token_type::Class{} },
-		{ "return", token_type::Return{} },
-		{ "if", token_type::If{} },
-		{ "else", token_type::Else{} },
-		{ "def", token_type::Def{} },
-		{ "print", token_type::Print{} },
-        { "and", token_type::And{} },
-		{ "or", token_type::Or{} },
-		{ "not", token_type::Not{} },
-        { "None", token_type::None{} },
-		{ "True", token_type::True{} },
-		{ "False", token_type::False{} }
-	};
-    
-    const std::istream& input_;
-    std::vector<Token> tokens_;
-    std::vector<Token>::const_iterator current_token_;
+    // Поток с исходным текстом либо nullptr, если лексер
+    // воспроизводит заранее разобранные токены
+    std::istream* input_ = nullptr;
+    // Лексер потоковый: токены разбираются по мере запросов NextToken.
+    // Очередной разбор может породить несколько токенов сразу
+    // (например, Newline и серию Indent/Dedent) - они накапливаются
+    // в очереди pending_ и выдаются по одному
+    std::deque<Token> pending_;
+    Token current_token_;
+    // Вид последнего выданного токена. Логике переводов строк и завершения
+    // файла важны только эти случаи, поэтому копия самого токена
+    // (вместе с его строковым значением) не хранится
+    enum class LastEmitted : char {
+        None,     // токены ещё не выдавались
+        Newline,  // последним был token_type::Newline
+        Dedent,   // последним был token_type::Dedent
+        Other,    // любой другой токен
+    };
+    LastEmitted last_emitted_ = LastEmitted::None;
+    bool eof_emitted_ = false;
     int space_count_ = 0;
-    
-    void ParseTokens(std::istream& input);
+
+    // Извлекает из очереди следующий токен, при необходимости разбирая ввод
+    Token FetchNextToken();
+    // Разбирает ввод до появления хотя бы одного токена в pending_
+    void TokenizeNext();
+    // Помещает токен в очередь
+    void Emit(Token token);
 
     //вспомогательные методы
 	void ParseChar(std::istream& input);
@@ -165,7 +181,7 @@ private:
 	void ParseId(std::istream& input);
 
 	void SkipSpaces(std::istream& input);
-	void SkipComment(std::istream& input); 
+	void SkipComment(std::istream& input);
 };
 
 }  // namespace parse
\ No newline at end of file
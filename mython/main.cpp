@@ -1,9 +1,14 @@
+#include "benchmark.h"
+#include "interpreter.h"
 #include "lexer.h"
+#include "optimize.h"
 #include "parse.h"
 #include "runtime.h"
 #include "statement.h"
 #include "test_runner_p.h"
+#include "vm.h"
 
+#include <fstream>
 #include <iostream>
 
 using namespace std;
@@ -14,23 +19,42 @@ void RunOpenLexerTests(TestRunner& tr);
 
 namespace ast {
 void RunUnitTests(TestRunner& tr);
+void RunOptimizerTests(TestRunner& tr);
+void RunSerializeTests(TestRunner& tr);
 }
 namespace runtime {
 void RunObjectHolderTests(TestRunner& tr);
 void RunObjectsTests(TestRunner& tr);
 }  // namespace runtime
 
+namespace vm {
+void RunVMTests(TestRunner& tr);
+}  // namespace vm
+
+namespace interpreter {
+void RunInterpreterTests(TestRunner& tr);
+}  // namespace interpreter
+
 void TestParseProgram(TestRunner& tr);
 
 namespace {
 
 void RunMythonProgram(istream& input, ostream& output) {
-    parse::Lexer lexer(input);
-    auto program = ParseProgram(lexer);
+    interpreter::Interpreter isolate;
+    isolate.Run(input, output);
+}
 
-    runtime::SimpleContext context{output};
-    runtime::Closure closure;
-    program->Execute(closure, context);
+// Читает файл path целиком одним обращением к файловой системе
+string ReadFile(const string& path) {
+    ifstream file{path, ios::binary | ios::ate};
+    if (!file) {
+        throw runtime_error("Cannot open file: "s + path);
+    }
+    const auto size = file.tellg();
+    string content(static_cast<size_t>(size), '\0');
+    file.seekg(0);
+    file.read(content.data(), size);
+    return content;
 }
 
 void TestSimplePrints() {
@@ -111,24 +135,69 @@ print y.value
     ASSERT_EQUAL(output.str(), "2\n3\n");
 }
 
+void TestWhileLoop() {
+    istringstream input(R"(
+i = 1
+total = 0
+while i <= 5:
+  total = total + i
+  i = i + 1
+
+print total, i
+
+while False:
+  print 'never'
+)");
+
+    ostringstream output;
+    RunMythonProgram(input, output);
+
+    ASSERT_EQUAL(output.str(), "15 6\n");
+}
+
 void TestAll() {
     TestRunner tr;
     parse::RunOpenLexerTests(tr);
     runtime::RunObjectHolderTests(tr);
     runtime::RunObjectsTests(tr);
     ast::RunUnitTests(tr);
+    ast::RunOptimizerTests(tr);
+    ast::RunSerializeTests(tr);
     TestParseProgram(tr);
+    vm::RunVMTests(tr);
+    interpreter::RunInterpreterTests(tr);
 
     RUN_TEST(tr, TestSimplePrints);
     RUN_TEST(tr, TestAssignments);
     RUN_TEST(tr, TestArithmetics);
     RUN_TEST(tr, TestVariablesArePointers);
+    RUN_TEST(tr, TestWhileLoop);
 }
 
 }  // namespace
 
-int main() {
+int main(int argc, char* argv[]) {
     try {
+        // С флагом --benchmark вместо тестов и программы из stdin
+        // выполняются микробенчмарки интерпретатора
+        if (argc > 1 && argv[1] == "--benchmark"sv) {
+            benchmark::RunBenchmarks(cout);
+            return 0;
+        }
+
+        // Производственный режим: mython <путь к скрипту>.
+        // Тесты пропускаются, скрипт читается с диска целиком одним чтением,
+        // а стандартные потоки отвязываются от stdio, чтобы print
+        // не платил за их синхронизацию. Запуск стоит ровно столько,
+        // сколько разбор и выполнение программы
+        if (argc > 1) {
+            ios_base::sync_with_stdio(false);
+            cin.tie(nullptr);
+            istringstream input{ReadFile(argv[1])};
+            RunMythonProgram(input, cout);
+            return 0;
+        }
+
         TestAll();
 
         RunMythonProgram(cin, cout);
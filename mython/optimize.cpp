@@ -0,0 +1,221 @@
+#include "optimize.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+using namespace std;
+
+namespace ast {
+
+namespace {
+
+using runtime::ObjectHolder;
+
+// Возвращает true, если узел - константа, значение которой известно
+// до выполнения программы
+bool IsConstant(Statement* node) {
+    return dynamic_cast<NumericConst*>(node) != nullptr
+           || dynamic_cast<StringConst*>(node) != nullptr
+           || dynamic_cast<BoolConst*>(node) != nullptr
+           || dynamic_cast<None*>(node) != nullptr;
+}
+
+// Вычисляет значение константного узла. Узел не обращается к closure
+// и context, поэтому подходят пустые заглушки
+ObjectHolder EvaluateConstant(Statement& node) {
+    runtime::Closure closure;
+    runtime::DummyContext context;
+    return node.Execute(closure, context);
+}
+
+// Создаёт узел-константу с тем же значением, что у value,
+// либо nullptr, если значение не представимо константой
+unique_ptr<Statement> MakeConstant(const ObjectHolder& value) {
+    if (const auto* number = value.TryAs<runtime::Number>()) {
+        return make_unique<NumericConst>(runtime::Number{number->GetValue()});
+    }
+    if (const auto* str = value.TryAs<runtime::String>()) {
+        return make_unique<StringConst>(runtime::String{str->GetValue()});
+    }
+    if (const auto* boolean = value.TryAs<runtime::Bool>()) {
+        return make_unique<BoolConst>(runtime::Bool{boolean->GetValue()});
+    }
+    return nullptr;
+}
+
+void FoldStatement(unique_ptr<Statement>& stmt);
+
+// Распознаёт идиому obj.field = obj.field + expr и заменяет stmt
+// суперинструкцией FieldAddAssign с одним виртуальным вызовом
+void FuseFieldAddAssign(unique_ptr<Statement>& stmt, FieldAssignment& assignment) {
+    auto* add = dynamic_cast<Add*>(&assignment.GetRightValue());
+    if (add == nullptr) {
+        return;
+    }
+    auto* read = dynamic_cast<VariableValue*>(add->GetLhs());
+    if (read == nullptr) {
+        return;
+    }
+
+    // Слева от + должно читаться то же поле того же объекта
+    const auto& object_ids = assignment.GetObject().GetDottedIds();
+    const auto& read_ids = read->GetDottedIds();
+    if (read_ids.size() != object_ids.size() + 1
+        || !std::equal(object_ids.begin(), object_ids.end(), read_ids.begin())
+        || !(read_ids.back() == assignment.GetFieldName())) {
+        return;
+    }
+
+    stmt = make_unique<FieldAddAssign>(assignment.GetObject(), assignment.GetFieldName(),
+                                       std::move(add->GetRhsPtr()));
+}
+
+// Сворачивает операнды выражения и, если всё поддерево константно,
+// заменяет stmt узлом-константой с заранее вычисленным значением
+void FoldExpression(unique_ptr<Statement>& stmt) {
+    if (stmt == nullptr || IsConstant(stmt.get())) {
+        return;
+    }
+
+    if (auto* binary = dynamic_cast<BinaryOperation*>(stmt.get())) {
+        FoldExpression(binary->GetLhsPtr());
+        FoldExpression(binary->GetRhsPtr());
+        if (!IsConstant(binary->GetLhs()) || !IsConstant(binary->GetRhs())) {
+            return;
+        }
+    } else if (auto* unary = dynamic_cast<UnaryOperation*>(stmt.get())) {
+        FoldExpression(unary->GetArgumentPtr());
+        if (!IsConstant(unary->GetArgument())) {
+            return;
+        }
+    } else {
+        // Не операция: вложенный вызов метода и т.п.
+        FoldStatement(stmt);
+        return;
+    }
+
+    try {
+        if (auto folded = MakeConstant(EvaluateConstant(*stmt))) {
+            stmt = std::move(folded);
+        }
+    } catch (const std::runtime_error&) {
+        // Вычисление завершилось ошибкой (например, 1/0) -
+        // оставляем узел как есть, ошибка возникнет во время выполнения
+    }
+}
+
+// Рекурсивно упрощает поддерево stmt, заменяя узлы на месте
+void FoldStatement(unique_ptr<Statement>& stmt) {
+    if (stmt == nullptr) {
+        return;
+    }
+
+    if (auto* compound = dynamic_cast<Compound*>(stmt.get())) {
+        for (auto& statement : compound->GetStatements()) {
+            FoldStatement(statement);
+        }
+        return;
+    }
+    if (auto* assignment = dynamic_cast<Assignment*>(stmt.get())) {
+        FoldExpression(assignment->GetRightValuePtr());
+        return;
+    }
+    if (auto* field_assignment = dynamic_cast<FieldAssignment*>(stmt.get())) {
+        FoldExpression(field_assignment->GetRightValuePtr());
+        FuseFieldAddAssign(stmt, *field_assignment);
+        return;
+    }
+    if (auto* field_add = dynamic_cast<FieldAddAssign*>(stmt.get())) {
+        FoldExpression(field_add->GetRightValuePtr());
+        return;
+    }
+    if (auto* print = dynamic_cast<Print*>(stmt.get())) {
+        for (auto& arg : print->GetArgs()) {
+            FoldExpression(arg);
+        }
+        return;
+    }
+    if (auto* call = dynamic_cast<MethodCall*>(stmt.get())) {
+        FoldStatement(call->GetObjectPtr());
+        for (auto& arg : call->GetArgs()) {
+            FoldExpression(arg);
+        }
+        return;
+    }
+    if (auto* method_body = dynamic_cast<MethodBody*>(stmt.get())) {
+        FoldStatement(method_body->GetBodyPtr());
+        return;
+    }
+    if (auto* return_stmt = dynamic_cast<Return*>(stmt.get())) {
+        FoldExpression(return_stmt->GetStatementPtr());
+        return;
+    }
+    if (auto* class_definition = dynamic_cast<ClassDefinition*>(stmt.get())) {
+        // Упрощаем тела методов объявляемого класса
+        auto* cls = class_definition->GetClass().TryAs<runtime::Class>();
+        for (auto& method : cls->GetMethods()) {
+            FoldStatement(method.body);
+        }
+        return;
+    }
+    if (auto* if_else = dynamic_cast<IfElse*>(stmt.get())) {
+        FoldExpression(if_else->GetConditionPtr());
+        FoldStatement(if_else->GetIfBodyPtr());
+        FoldStatement(if_else->GetElseBodyPtr());
+
+        // Константное условие: инструкция if заменяется телом взятой ветки
+        if (IsConstant(&if_else->GetCondition())) {
+            if (runtime::IsTrue(EvaluateConstant(if_else->GetCondition()))) {
+                stmt = std::move(if_else->GetIfBodyPtr());
+            } else if (if_else->GetElseBody() != nullptr) {
+                stmt = std::move(if_else->GetElseBodyPtr());
+            } else {
+                // Ветка else отсутствует - инструкция ничего не делает
+                stmt = make_unique<Compound>();
+            }
+        } else if (auto* comparison = dynamic_cast<Comparison*>(&if_else->GetCondition())) {
+            // Условие-сравнение: if и сравнение сливаются в суперинструкцию
+            stmt = make_unique<CompareBranch>(comparison->GetComparator(),
+                                              std::move(comparison->GetLhsPtr()),
+                                              std::move(comparison->GetRhsPtr()),
+                                              std::move(if_else->GetIfBodyPtr()),
+                                              std::move(if_else->GetElseBodyPtr()));
+        }
+        return;
+    }
+    if (auto* compare_branch = dynamic_cast<CompareBranch*>(stmt.get())) {
+        // Уже слитая инструкция: упрощаем её ветки
+        FoldStatement(compare_branch->GetIfBodyPtr());
+        FoldStatement(compare_branch->GetElseBodyPtr());
+        return;
+    }
+    if (auto* loop = dynamic_cast<While*>(stmt.get())) {
+        FoldExpression(loop->GetConditionPtr());
+        FoldStatement(loop->GetBodyPtr());
+
+        // Заведомо ложное условие: цикл не выполнится ни разу
+        if (IsConstant(&loop->GetCondition())
+            && !runtime::IsTrue(EvaluateConstant(loop->GetCondition()))) {
+            stmt = make_unique<Compound>();
+        }
+        return;
+    }
+    if (dynamic_cast<BinaryOperation*>(stmt.get()) != nullptr
+        || dynamic_cast<UnaryOperation*>(stmt.get()) != nullptr) {
+        // Выражение верхнего уровня (например, вызов в составе арифметики)
+        FoldExpression(stmt);
+        return;
+    }
+    // Остальные узлы (VariableValue, NewInstance, None, константы)
+    // дочерних инструкций для упрощения не содержат
+}
+
+}  // namespace
+
+unique_ptr<Statement> Optimize(unique_ptr<Statement> program) {
+    FoldStatement(program);
+    return program;
+}
+
+}  // namespace ast
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "statement.h"
+
+#include <memory>
+
+namespace ast {
+
+/*
+ * Проход оптимизации дерева программы, построенного ParseProgram.
+ * Сворачивает константные подвыражения (арифметику, конкатенацию строк,
+ * логические операции и сравнения над константами) в узлы-константы
+ * и удаляет ветки if/else с константным условием.
+ *
+ * Подвыражения, вычисление которых завершается ошибкой (например, деление
+ * на ноль), не сворачиваются: ошибка возникнет во время выполнения,
+ * как и без оптимизации
+ */
+std::unique_ptr<Statement> Optimize(std::unique_ptr<Statement> program);
+
+}  // namespace ast
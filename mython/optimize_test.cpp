@@ -0,0 +1,173 @@
+#include "lexer.h"
+#include "optimize.h"
+#include "parse.h"
+#include "test_runner_p.h"
+
+using namespace std;
+
+namespace ast {
+
+namespace {
+
+// Разбирает программу и возвращает её оптимизированное дерево
+unique_ptr<Statement> ParseAndOptimize(const string& program) {
+    istringstream is(program);
+    parse::Lexer lexer(is);
+    return Optimize(ParseProgram(lexer));
+}
+
+// Возвращает результат выполнения оптимизированной программы
+string RunOptimizedProgram(const string& program) {
+    auto tree = ParseAndOptimize(program);
+
+    runtime::DummyContext context;
+    runtime::Closure closure;
+    tree->Execute(closure, context);
+
+    return context.output.str();
+}
+
+}  // namespace
+
+void TestFoldsConstantArithmetics() {
+    auto lhs = make_unique<NumericConst>(runtime::Number{2});
+    auto rhs = make_unique<NumericConst>(runtime::Number{3});
+    auto sum = make_unique<Add>(std::move(lhs), std::move(rhs));
+    auto tree = Optimize(make_unique<Mult>(std::move(sum), make_unique<NumericConst>(runtime::Number{4})));
+
+    const auto* folded = dynamic_cast<const NumericConst*>(tree.get());
+    ASSERT(folded != nullptr);
+    ASSERT_EQUAL(folded->GetValue().GetValue(), 20);
+}
+
+void TestKeepsNonConstantExpressions() {
+    auto sum = make_unique<Add>(make_unique<VariableValue>("x"s),
+                                make_unique<NumericConst>(runtime::Number{1}));
+    auto tree = Optimize(std::move(sum));
+    ASSERT(dynamic_cast<const Add*>(tree.get()) != nullptr);
+
+    // Деление на ноль не сворачивается: ошибка должна возникнуть во время выполнения
+    auto division = make_unique<Div>(make_unique<NumericConst>(runtime::Number{1}),
+                                     make_unique<NumericConst>(runtime::Number{0}));
+    tree = Optimize(std::move(division));
+    ASSERT(dynamic_cast<const Div*>(tree.get()) != nullptr);
+}
+
+void TestPrunesConstantCondition() {
+    auto condition = make_unique<SpecializedComparison<runtime::Less>>(
+        make_unique<NumericConst>(runtime::Number{2}), make_unique<NumericConst>(runtime::Number{1}));
+    auto if_body = make_unique<Print>(make_unique<StringConst>(runtime::String{"if"s}));
+    auto else_body = make_unique<Assignment>("x"s, make_unique<NumericConst>(runtime::Number{42}));
+    auto tree = Optimize(make_unique<IfElse>(std::move(condition), std::move(if_body),
+                                             std::move(else_body)));
+
+    // Условие ложно - от инструкции if остаётся тело ветки else
+    ASSERT(dynamic_cast<const Assignment*>(tree.get()) != nullptr);
+}
+
+void TestFusesFieldAddAssign() {
+    // self.field = self.field + expr сливается в суперинструкцию
+    auto read = make_unique<VariableValue>(vector<string>{"self"s, "total"s});
+    auto sum = make_unique<Add>(std::move(read), make_unique<VariableValue>("d"s));
+    auto tree = Optimize(make_unique<FieldAssignment>(VariableValue{vector<string>{"self"s}},
+                                                      "total"s, std::move(sum)));
+    ASSERT(dynamic_cast<const FieldAddAssign*>(tree.get()) != nullptr);
+
+    // Чтение другого поля суперинструкцией не является
+    auto other_read = make_unique<VariableValue>(vector<string>{"self"s, "other"s});
+    auto other_sum = make_unique<Add>(std::move(other_read), make_unique<VariableValue>("d"s));
+    tree = Optimize(make_unique<FieldAssignment>(VariableValue{vector<string>{"self"s}},
+                                                 "total"s, std::move(other_sum)));
+    ASSERT(dynamic_cast<const FieldAssignment*>(tree.get()) != nullptr);
+}
+
+void TestFusesCompareBranch() {
+    // if x == y: с неконстантным сравнением сливается в суперинструкцию
+    auto condition = make_unique<SpecializedComparison<runtime::Equal>>(
+        make_unique<VariableValue>("x"s), make_unique<VariableValue>("y"s));
+    auto if_body = make_unique<Print>(make_unique<StringConst>(runtime::String{"eq"s}));
+    auto tree = Optimize(make_unique<IfElse>(std::move(condition), std::move(if_body), nullptr));
+
+    const auto* fused = dynamic_cast<const CompareBranch*>(tree.get());
+    ASSERT(fused != nullptr);
+    ASSERT(fused->GetComparator() == &runtime::Equal);
+    ASSERT(fused->GetElseBody() == nullptr);
+}
+
+void TestFusedProgramsBehaveTheSame() {
+    const string program = R"(
+class Counter:
+  def __init__():
+    self.total = 0
+
+  def add(d):
+    self.total = self.total + d
+    if self.total > 100:
+      self.total = 0
+
+c = Counter()
+i = 0
+while i < 7:
+  c.add(i * 10)
+  i = i + 1
+
+print c.total
+)"s;
+    // 0+10+...+60 = 210, после 150 счётчик дважды сбрасывается: остаётся 60
+    ASSERT_EQUAL(RunOptimizedProgram(program), "60\n"s);
+
+    // Суперинструкция сохраняет конкатенацию строк и вызов __add__
+    const string strings = R"(
+class Joiner:
+  def __init__():
+    self.text = ''
+
+  def join(part):
+    self.text = self.text + part
+
+j = Joiner()
+j.join('a')
+j.join('b')
+if j.text == 'ab':
+  print 'fused ok'
+else:
+  print 'broken'
+)"s;
+    ASSERT_EQUAL(RunOptimizedProgram(strings), "fused ok\n"s);
+}
+
+void TestOptimizedProgramsBehaveTheSame() {
+    ASSERT_EQUAL(RunOptimizedProgram("print 1+2+3+4+5, 'ab' + 'c', not True, 2 > 1 and 1 > 2"s),
+                 "15 abc False False\n"s);
+
+    const string program = R"(
+x = 10
+if 1 < 2:
+  print x + 5 * 2
+else:
+  print 'dead branch'
+)"s;
+    ASSERT_EQUAL(RunOptimizedProgram(program), "20\n"s);
+
+    const string methods = R"(
+class Greeter:
+  def greeting():
+    return 'hello' + ', ' + 'world'
+
+g = Greeter()
+print g.greeting()
+)"s;
+    ASSERT_EQUAL(RunOptimizedProgram(methods), "hello, world\n"s);
+}
+
+void RunOptimizerTests(TestRunner& tr) {
+    RUN_TEST(tr, ast::TestFoldsConstantArithmetics);
+    RUN_TEST(tr, ast::TestKeepsNonConstantExpressions);
+    RUN_TEST(tr, ast::TestPrunesConstantCondition);
+    RUN_TEST(tr, ast::TestFusesFieldAddAssign);
+    RUN_TEST(tr, ast::TestFusesCompareBranch);
+    RUN_TEST(tr, ast::TestFusedProgramsBehaveTheSame);
+    RUN_TEST(tr, ast::TestOptimizedProgramsBehaveTheSame);
+}
+
+}  // namespace ast
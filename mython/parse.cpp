@@ -3,6 +3,10 @@
 #include "lexer.h"
 #include "statement.h"
 
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
 using namespace std;
 
 namespace TokenType = parse::token_type;
@@ -17,10 +21,32 @@ bool operator!=(const parse::Token& token, char c) {
     return !(token == c);
 }
 
+// Таблицы парсера: объявленные классы и интернированные строковые литералы.
+// В режиме ParseMode::Lazy таблицы переживают сам парсер - их разделяют
+// отложенные тела методов, которым они нужны при разборе.
+// Классы хранятся невладеющими ссылками: владеет классом его узел
+// ast::ClassDefinition. Иначе возник бы цикл владения
+// таблицы -> класс -> отложенное тело метода -> таблицы,
+// и ни один из этих объектов никогда бы не разрушался
+struct ParserTables {
+    runtime::Closure declared_classes;
+    std::unordered_map<string, runtime::String> string_literals;
+};
+
+// Создаёт отложенное тело метода: tokens разбираются при первом вызове
+unique_ptr<runtime::Executable> MakeDeferredMethodBody(vector<parse::Token> tokens,
+                                                       shared_ptr<ParserTables> tables);
+
 class Parser {
 public:
-    explicit Parser(parse::Lexer& lexer)
-        : lexer_(lexer) {
+    explicit Parser(parse::Lexer& lexer, ParseMode mode = ParseMode::Eager)
+        : lexer_(lexer), mode_(mode), tables_(make_shared<ParserTables>()) {
+    }
+
+    // Создаёт парсер поверх таблиц tables внешнего парсера.
+    // Используется при отложенном разборе тел методов
+    Parser(parse::Lexer& lexer, shared_ptr<ParserTables> tables)
+        : lexer_(lexer), mode_(ParseMode::Lazy), tables_(std::move(tables)) {
     }
 
     // Program -> eps
@@ -34,6 +60,11 @@ public:
         return result;
     }
 
+    // Разбирает Suite отложенного тела метода (режим ParseMode::Lazy)
+    unique_ptr<ast::Statement> ParseDeferredSuite() {
+        return make_unique<ast::MethodBody>(ParseSuite());
+    }
+
 private:
     // Suite -> NEWLINE INDENT (Statement)+ DEDENT
     unique_ptr<ast::Statement> ParseSuite()  // NOLINT
@@ -54,6 +85,32 @@ private:
         return result;
     }
 
+    // Захватывает токены Suite, не разбирая их: NEWLINE INDENT ... DEDENT.
+    // Вложенные блоки учитываются подсчётом глубины отступа
+    vector<parse::Token> CaptureSuiteTokens() {
+        vector<parse::Token> tokens;
+        lexer_.Expect<TokenType::Newline>();
+        tokens.push_back(lexer_.CurrentToken());
+        lexer_.ExpectNext<TokenType::Indent>();
+        tokens.push_back(lexer_.CurrentToken());
+
+        int depth = 1;
+        while (depth > 0) {
+            const parse::Token token = lexer_.NextToken();
+            if (token.Is<TokenType::Indent>()) {
+                ++depth;
+            } else if (token.Is<TokenType::Dedent>()) {
+                --depth;
+            } else if (token.Is<TokenType::Eof>()) {
+                throw ParseError("Unexpected end of file inside a method body"s);
+            }
+            tokens.push_back(token);
+        }
+        lexer_.NextToken();
+
+        return tokens;
+    }
+
     // Methods -> [def id(Params) : Suite]*
     vector<runtime::Method> ParseMethods()  // NOLINT
     {
@@ -76,7 +133,11 @@ private:
             lexer_.ExpectNext<TokenType::Char>(':');
             lexer_.NextToken();
 
-            m.body = std::make_unique<ast::MethodBody>(ParseSuite());  // NOLINT
+            if (mode_ == ParseMode::Lazy) {
+                m.body = MakeDeferredMethodBody(CaptureSuiteTokens(), tables_);
+            } else {
+                m.body = std::make_unique<ast::MethodBody>(ParseSuite());  // NOLINT
+            }
 
             result.push_back(std::move(m));
         }
@@ -96,8 +157,8 @@ private:
             lexer_.ExpectNext<TokenType::Char>(')');
             lexer_.NextToken();
 
-            auto it = declared_classes_.find(name);
-            if (it == declared_classes_.end()) {
+            auto it = tables_->declared_classes.find(name);
+            if (it == tables_->declared_classes.end()) {
                 throw ParseError("Base class "s + name + " not found for class "s + class_name);
             }
             base_class = static_cast<const runtime::Class*>(it->second.Get());  // NOLINT
@@ -112,16 +173,21 @@ private:
         lexer_.Expect<TokenType::Dedent>();
         lexer_.NextToken();
 
-        auto [it, inserted] = declared_classes_.insert({
+        auto cls = runtime::ObjectHolder::Own(runtime::Class(class_name, std::move(methods), base_class));
+
+        // В таблицу кладётся невладеющая ссылка: класс жив, пока жив
+        // возвращаемый узел ast::ClassDefinition, а он переживает
+        // все обращения к таблице
+        auto [it, inserted] = tables_->declared_classes.insert({
             class_name,
-            runtime::ObjectHolder::Own(runtime::Class(class_name, std::move(methods), base_class)),
+            runtime::ObjectHolder::Share(*cls.Get()),
         });
 
         if (!inserted) {
             throw ParseError("Class "s + class_name + " already exists"s);
         }
 
-        return make_unique<ast::ClassDefinition>(it->second);
+        return make_unique<ast::ClassDefinition>(std::move(cls));
     }
 
     vector<string> ParseDottedIds() {
@@ -234,7 +300,7 @@ private:
         if (const auto* str = lexer_.CurrentToken().TryAs<TokenType::String>()) {
             string result = str->value;
             lexer_.NextToken();
-            return make_unique<ast::StringConst>(std::move(result));
+            return make_unique<ast::StringConst>(InternStringLiteral(std::move(result)));
         }
         if (lexer_.CurrentToken().Is<TokenType::True>()) {
             lexer_.NextToken();
@@ -272,7 +338,8 @@ private:
                     make_unique<ast::VariableValue>(std::move(names)), std::move(method_name),
                     std::move(args));
             }
-            if (auto it = declared_classes_.find(method_name); it != declared_classes_.end()) {
+            if (auto it = tables_->declared_classes.find(method_name);
+                it != tables_->declared_classes.end()) {
                 return make_unique<ast::NewInstance>(
                     static_cast<const runtime::Class&>(*it->second), std::move(args));  // NOLINT
             }
@@ -323,6 +390,22 @@ private:
                                         std::move(else_body));
     }
 
+    // While -> while LogicalExpr: Suite
+    unique_ptr<ast::Statement> ParseWhile()  // NOLINT
+    {
+        lexer_.Expect<TokenType::While>();
+        lexer_.NextToken();
+
+        auto condition = ParseTest();
+
+        lexer_.Expect<TokenType::Char>(':');
+        lexer_.NextToken();
+
+        auto body = ParseSuite();
+
+        return make_unique<ast::While>(std::move(condition), std::move(body));
+    }
+
     // LogicalExpr -> AndTest [OR AndTest]
     // AndTest -> NotTest [AND NotTest]
     // NotTest -> [NOT] NotTest
@@ -365,32 +448,32 @@ private:
 
         if (tok == '<') {
             lexer_.NextToken();
-            return make_unique<ast::Comparison>(runtime::Less, std::move(result),
+            return make_unique<ast::SpecializedComparison<runtime::Less>>(std::move(result),
                                                 ParseExpression());
         }
         if (tok == '>') {
             lexer_.NextToken();
-            return make_unique<ast::Comparison>(runtime::Greater, std::move(result),
+            return make_unique<ast::SpecializedComparison<runtime::Greater>>(std::move(result),
                                                 ParseExpression());
         }
         if (tok.Is<TokenType::Eq>()) {
             lexer_.NextToken();
-            return make_unique<ast::Comparison>(runtime::Equal, std::move(result),
+            return make_unique<ast::SpecializedComparison<runtime::Equal>>(std::move(result),
                                                 ParseExpression());
         }
         if (tok.Is<TokenType::NotEq>()) {
             lexer_.NextToken();
-            return make_unique<ast::Comparison>(runtime::NotEqual, std::move(result),
+            return make_unique<ast::SpecializedComparison<runtime::NotEqual>>(std::move(result),
                                                 ParseExpression());
         }
         if (tok.Is<TokenType::LessOrEq>()) {
             lexer_.NextToken();
-            return make_unique<ast::Comparison>(runtime::LessOrEqual, std::move(result),
+            return make_unique<ast::SpecializedComparison<runtime::LessOrEqual>>(std::move(result),
                                                 ParseExpression());
         }
         if (tok.Is<TokenType::GreaterOrEq>()) {
             lexer_.NextToken();
-            return make_unique<ast::Comparison>(runtime::GreaterOrEqual, std::move(result),
+            return make_unique<ast::SpecializedComparison<runtime::GreaterOrEqual>>(std::move(result),
                                                 ParseExpression());
         }
         return result;
@@ -399,6 +482,7 @@ private:
     // Statement -> SimpleStatement Newline
     //           | class ClassDefinition
     //           | if Condition
+    //           | while While
     unique_ptr<ast::Statement> ParseStatement()  // NOLINT
     {
         const auto& tok = lexer_.CurrentToken();
@@ -410,6 +494,9 @@ private:
         if (tok.Is<TokenType::If>()) {
             return ParseCondition();
         }
+        if (tok.Is<TokenType::While>()) {
+            return ParseWhile();
+        }
         auto result = ParseSimpleStatement();
         lexer_.Expect<TokenType::Newline>();
         lexer_.NextToken();
@@ -438,11 +525,65 @@ private:
     }
 
     parse::Lexer& lexer_;
-    runtime::Closure declared_classes_;
+    // Возвращает строковое значение литерала value. Одинаковые литералы
+    // разделяют один буфер символов
+    runtime::String InternStringLiteral(string value) {
+        auto& literals = tables_->string_literals;
+        if (auto it = literals.find(value); it != literals.end()) {
+            return it->second;
+        }
+        runtime::String str{value};
+        return literals.emplace(std::move(value), std::move(str)).first->second;
+    }
+
+    ParseMode mode_;
+    shared_ptr<ParserTables> tables_;
+};
+
+/*
+ * Тело метода, разбор которого отложен до первого вызова. До разбора хранит
+ * последовательность токенов тела; при первом Execute строит дерево
+ * ast::MethodBody и дальше делегирует выполнение ему. Разбор защищён
+ * call_once: впервые вызвать метод могут одновременно несколько потоков,
+ * выполняющих общий снимок программы
+ */
+class DeferredMethodBody : public runtime::Executable {
+public:
+    DeferredMethodBody(vector<parse::Token> tokens, shared_ptr<ParserTables> tables)
+        : tokens_(std::move(tokens)), tables_(std::move(tables)) {
+    }
+
+    runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override {
+        std::call_once(parsed_, [this] { Materialize(); });
+        return body_->Execute(closure, context);
+    }
+
+private:
+    void Materialize() {
+        parse::Lexer lexer{std::move(tokens_)};
+        Parser parser{lexer, tables_};
+        body_ = parser.ParseDeferredSuite();
+        // После разбора таблицы не нужны: классы принадлежат узлам
+        // ast::ClassDefinition программы, а строковые литералы дерева
+        // разделяют буферы интернированных строк по счётчику ссылок
+        tokens_ = {};
+        tables_.reset();
+    }
+
+    std::vector<parse::Token> tokens_;
+    // Таблицы нужны только для разбора и освобождаются в Materialize
+    shared_ptr<ParserTables> tables_;
+    std::once_flag parsed_;
+    unique_ptr<ast::Statement> body_;
 };
 
+unique_ptr<runtime::Executable> MakeDeferredMethodBody(vector<parse::Token> tokens,
+                                                       shared_ptr<ParserTables> tables) {
+    return make_unique<DeferredMethodBody>(std::move(tokens), std::move(tables));
+}
+
 }  // namespace
 
-unique_ptr<runtime::Executable> ParseProgram(parse::Lexer& lexer) {
-    return Parser{lexer}.ParseProgram();
+unique_ptr<runtime::Executable> ParseProgram(parse::Lexer& lexer, ParseMode mode) {
+    return Parser{lexer, mode}.ParseProgram();
 }
\ No newline at end of file
@@ -15,4 +15,15 @@ struct ParseError : std::runtime_error {
     using std::runtime_error::runtime_error;
 };
 
-std::unique_ptr<runtime::Executable> ParseProgram(parse::Lexer& lexer);
\ No newline at end of file
+// Режим разбора тел методов
+enum class ParseMode {
+    // Тела методов разбираются сразу, при чтении объявления класса
+    Eager,
+    // Тело метода захватывается как последовательность токенов и разбирается
+    // при первом вызове метода. Ускоряет запуск программ, в которых
+    // значительная часть методов не вызывается
+    Lazy,
+};
+
+std::unique_ptr<runtime::Executable> ParseProgram(parse::Lexer& lexer,
+                                                  ParseMode mode = ParseMode::Eager);
\ No newline at end of file
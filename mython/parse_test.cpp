@@ -244,6 +244,67 @@ print r, c, t1, t2
                  "Rect(10x20) Circle(52) Triangle(3, 4, 5) Wrong triangle\n"s);
 }
 
+void TestLazyMethodBodies() {
+    // Метод wasteful никогда не вызывается: в режиме Lazy его тело
+    // остаётся неразобранным и не влияет ни на запуск, ни на выполнение
+    const string program = R"(
+class Library:
+  def __init__():
+    self.hits = 0
+
+  def touch():
+    self.hits = self.hits + 1
+    return self.hits
+
+  def wasteful():
+    x = Unknown()
+    return x
+
+lib = Library()
+lib.touch()
+print lib.touch()
+)"s;
+
+    istringstream is(program);
+    parse::Lexer lexer(is);
+    auto tree = ParseProgram(lexer, ParseMode::Lazy);
+
+    runtime::DummyContext context;
+    runtime::Closure closure;
+    tree->Execute(closure, context);
+
+    ASSERT_EQUAL(context.output.str(), "2\n"s);
+}
+
+void TestLazyBodyErrorSurfacesOnCall() {
+    const string program = R"(
+class Broken:
+  def __init__():
+    self.x = 0
+
+  def explode():
+    y = Unknown()
+    return y
+
+b = Broken()
+b.explode()
+)"s;
+
+    istringstream is(program);
+    parse::Lexer lexer(is);
+    auto tree = ParseProgram(lexer, ParseMode::Lazy);
+
+    runtime::DummyContext context;
+    runtime::Closure closure;
+    // Ошибка в теле метода обнаруживается при первом вызове
+    try {
+        tree->Execute(closure, context);
+        ASSERT(false);
+    } catch (const ParseError&) {
+        // ожидаемо
+    }
+}
+
 }  // namespace parse
 
 void TestParseProgram(TestRunner& tr) {
@@ -255,4 +316,6 @@ void TestParseProgram(TestRunner& tr) {
     RUN_TEST(tr, parse::TestRecursion2);
     RUN_TEST(tr, parse::TestComplexLogicalExpression);
     RUN_TEST(tr, parse::TestClassicalPolymorphism);
+    RUN_TEST(tr, parse::TestLazyMethodBodies);
+    RUN_TEST(tr, parse::TestLazyBodyErrorSurfacesOnCall);
 }
\ No newline at end of file
@@ -1,24 +1,265 @@
 #include "runtime.h"
 
 #include <cassert>
+#include <charconv>
 #include <optional>
 #include <sstream>
+#include <unordered_set>
 
 using namespace std;
 
 namespace runtime {
 
+namespace {
+// Текущая арена потока, используемая ObjectHolder::Own
+thread_local ObjectArena* current_arena = nullptr;
+// Счётчики текущего потока, устанавливаемые InstrumentedContext
+thread_local InstrumentationStats* current_stats = nullptr;
+}  // namespace
+
+InstrumentationStats* CurrentInstrumentation() {
+    return current_stats;
+}
+
+InstrumentedContext::InstrumentedContext(std::ostream& output)
+    : output_(output)
+    , previous_(current_stats) {
+    current_stats = &stats_;
+}
+
+InstrumentedContext::~InstrumentedContext() {
+    current_stats = previous_;
+}
+
+CallFrame::CallFrame()
+    : frame_(Acquire()) {
+}
+
+CallFrame::~CallFrame() {
+    frame_->closure.clear();
+    frame_->args.clear();
+    Release(std::move(frame_));
+}
+
+std::unique_ptr<CallFrame::Frame> CallFrame::Acquire() {
+    auto& pool = FreeFrames();
+    if (pool.empty()) {
+        return std::make_unique<Frame>();
+    }
+    auto frame = std::move(pool.back());
+    pool.pop_back();
+    return frame;
+}
+
+void CallFrame::Release(std::unique_ptr<Frame> frame) {
+    FreeFrames().push_back(std::move(frame));
+}
+
+std::vector<std::unique_ptr<CallFrame::Frame>>& CallFrame::FreeFrames() {
+    // Свободные кадры текущего потока
+    thread_local std::vector<std::unique_ptr<Frame>> free_frames;
+    return free_frames;
+}
+
+ObjectArena::Scope::Scope(ObjectArena& arena)
+    : previous_(current_arena) {
+    current_arena = &arena;
+}
+
+ObjectArena::Scope::~Scope() {
+    current_arena = previous_;
+}
+
+ObjectArena* ObjectArena::Current() {
+    return current_arena;
+}
+
+void CycleCollector::Track(const std::shared_ptr<ClassInstance>& instance) {
+    auto& tracked = Registry();
+    if (tracked.size() == tracked.capacity()) {
+        // Перед ростом буфера убираем записи об уже разрушенных экземплярах
+        tracked.erase(std::remove_if(tracked.begin(), tracked.end(),
+                                     [](const std::weak_ptr<ClassInstance>& entry) {
+                                         return entry.expired();
+                                     }),
+                      tracked.end());
+    }
+    tracked.push_back(instance);
+}
+
+namespace {
+
+// Помечает экземпляры, достижимые из value по полям
+void MarkReachable(const ObjectHolder& value, std::unordered_set<const ClassInstance*>& marked) {
+    const auto* instance = value.TryAs<ClassInstance>();
+    if (instance == nullptr || !marked.insert(instance).second) {
+        return;
+    }
+    for (const auto& [name, field] : instance->Fields()) {
+        MarkReachable(field, marked);
+    }
+}
+
+}  // namespace
+
+size_t CycleCollector::CollectCycles(std::initializer_list<const Closure*> roots) {
+    std::unordered_set<const ClassInstance*> marked;
+    for (const Closure* root : roots) {
+        for (const auto& [name, value] : *root) {
+            MarkReachable(value, marked);
+        }
+    }
+
+    // Живой, но недостижимый экземпляр удерживается только циклом ссылок.
+    // Весь цикл сначала захватывается сильными ссылками: разрыв одного звена
+    // не должен разрушать соседние экземпляры посреди обхода
+    auto& tracked = Registry();
+    std::vector<std::shared_ptr<ClassInstance>> cyclic;
+    for (const auto& entry : tracked) {
+        if (auto instance = entry.lock();
+            instance != nullptr && marked.count(instance.get()) == 0) {
+            cyclic.push_back(std::move(instance));
+        }
+    }
+
+    const size_t collected = cyclic.size();
+    for (const auto& instance : cyclic) {
+        instance->Fields().clear();
+    }
+    cyclic.clear();
+
+    tracked.erase(std::remove_if(tracked.begin(), tracked.end(),
+                                 [](const std::weak_ptr<ClassInstance>& entry) {
+                                     return entry.expired();
+                                 }),
+                  tracked.end());
+    return collected;
+}
+
+std::vector<std::weak_ptr<ClassInstance>>& CycleCollector::Registry() {
+    if (ObjectArena* arena = ObjectArena::Current()) {
+        return arena->TrackedInstances();
+    }
+    // Запасной реестр для экземпляров, созданных без арены
+    thread_local std::vector<std::weak_ptr<ClassInstance>> fallback;
+    return fallback;
+}
+
 ObjectHolder::ObjectHolder(std::shared_ptr<Object> data)
     : data_(std::move(data)) {
+    if (data_ != nullptr) {
+        storage_ = Storage::Shared;
+    }
+}
+
+ObjectHolder::ObjectHolder(const ObjectHolder& other) {
+    CopyFrom(other);
+}
+
+ObjectHolder::ObjectHolder(ObjectHolder&& other) noexcept {
+    if (other.storage_ == Storage::Shared) {
+        data_ = std::move(other.data_);
+        storage_ = Storage::Shared;
+    } else {
+        CopyFrom(other);
+    }
+    other.Reset();
+}
+
+ObjectHolder& ObjectHolder::operator=(const ObjectHolder& other) {
+    if (this != &other) {
+        Reset();
+        CopyFrom(other);
+    }
+    return *this;
+}
+
+ObjectHolder& ObjectHolder::operator=(ObjectHolder&& other) noexcept {
+    if (this != &other) {
+        Reset();
+        if (other.storage_ == Storage::Shared) {
+            data_ = std::move(other.data_);
+            storage_ = Storage::Shared;
+        } else {
+            CopyFrom(other);
+        }
+        other.Reset();
+    }
+    return *this;
+}
+
+ObjectHolder::~ObjectHolder() {
+    Reset();
+}
+
+void ObjectHolder::EmplaceInline(const Number& value) {
+    new (&inline_data_) Number(value);
+    storage_ = Storage::InlineNumber;
+}
+
+void ObjectHolder::EmplaceInline(const Bool& value) {
+    new (&inline_data_) Bool(value);
+    storage_ = Storage::InlineBool;
+}
+
+void ObjectHolder::CopyFrom(const ObjectHolder& other) {
+    switch (other.storage_) {
+        case Storage::Empty:
+            break;
+        case Storage::InlineNumber:
+            EmplaceInline(static_cast<const Number&>(*other.GetInline()));
+            break;
+        case Storage::InlineBool:
+            EmplaceInline(static_cast<const Bool&>(*other.GetInline()));
+            break;
+        case Storage::Shared:
+            data_ = other.data_;
+            storage_ = Storage::Shared;
+            break;
+        case Storage::Borrowed:
+            borrowed_ = other.borrowed_;
+            storage_ = Storage::Borrowed;
+            break;
+    }
+}
+
+void ObjectHolder::Reset() {
+    switch (storage_) {
+        case Storage::Empty:
+            break;
+        case Storage::InlineNumber:
+        case Storage::InlineBool:
+            GetInline()->~Object();
+            break;
+        case Storage::Shared:
+            data_.reset();
+            break;
+        case Storage::Borrowed:
+            borrowed_ = nullptr;
+            break;
+    }
+    storage_ = Storage::Empty;
+}
+
+Object* ObjectHolder::GetInline() const {
+    return std::launder(
+        reinterpret_cast<Object*>(const_cast<void*>(static_cast<const void*>(&inline_data_))));
 }
 
 void ObjectHolder::AssertIsValid() const {
-    assert(data_ != nullptr);
+    assert(Get() != nullptr);
 }
 
 ObjectHolder ObjectHolder::Share(Object& object) {
-    // Возвращаем невладеющий shared_ptr (его deleter ничего не делает)
-    return ObjectHolder(std::shared_ptr<Object>(&object, [](auto* /*p*/) { /* do nothing */ }));
+    // Невладеющая ссылка: ни блока управления, ни атомарного счётчика
+    ObjectHolder holder;
+    holder.borrowed_ = &object;
+    holder.storage_ = Storage::Borrowed;
+    return holder;
+}
+
+bool ObjectHolder::IsSoleOwner() const {
+    return storage_ == Storage::Shared && data_.use_count() == 1;
 }
 
 ObjectHolder ObjectHolder::None() {
@@ -36,6 +277,16 @@ Object* ObjectHolder::operator->() const {
 }
 
 Object* ObjectHolder::Get() const {
+    switch (storage_) {
+        case Storage::InlineNumber:
+        case Storage::InlineBool:
+            return GetInline();
+        case Storage::Borrowed:
+            return borrowed_;
+        case Storage::Empty:
+        case Storage::Shared:
+            break;
+    }
     return data_.get();
 }
 
@@ -43,32 +294,88 @@ ObjectHolder::operator bool() const {
     return Get() != nullptr;
 }
 
+namespace {
+
+// Дописывает представление значения в buffer. Возвращает false,
+// если тип значения требует вывода через метод Print
+bool AppendValue(string& buffer, const ObjectHolder& value) {
+    if (!value) {
+        buffer += "None"sv;
+        return true;
+    }
+    switch (value->GetType()) {
+        case Object::Type::Number: {
+            array<char, 16> digits;  // NOLINT(cppcoreguidelines-pro-type-member-init,hicpp-member-init)
+            const auto result = to_chars(digits.data(), digits.data() + digits.size(),
+                                         static_cast<const Number*>(value.Get())->GetValue());
+            buffer.append(digits.data(), result.ptr);
+            return true;
+        }
+        case Object::Type::String:
+            buffer += static_cast<const String*>(value.Get())->GetValue();
+            return true;
+        case Object::Type::Bool:
+            buffer += static_cast<const Bool*>(value.Get())->GetValue() ? "True"sv : "False"sv;
+            return true;
+        default:
+            return false;
+    }
+}
+
+}  // namespace
+
+void PrintValue(const ObjectHolder& value, Context& context) {
+    if (string* buffer = context.GetOutputBuffer()) {
+        if (AppendValue(*buffer, value)) {
+            return;
+        }
+    }
+    if (value) {
+        value->Print(context.GetOutputStream(), context);
+    } else {
+        context.GetOutputStream() << "None"sv;
+    }
+}
+
+ObjectHolder ToString(const ObjectHolder& value, Context& context) {
+    string result;
+    if (!AppendValue(result, value)) {
+        // Прочие значения (например, объекты с методом __str__)
+        // выводятся методом Print
+        ostringstream os;
+        value->Print(os, context);
+        result = os.str();
+    }
+    return ObjectHolder::Own(String{std::move(result)});
+}
+
 bool IsTrue(const ObjectHolder& object) {
     if (!object) {
         return false;
     }
 
-    if (auto obj = object.TryAs<Bool>()) {
-        return obj->GetValue() == true;
-    }
-    if (auto obj = object.TryAs<Number>()) {
-        return !(obj->GetValue() == 0);
-    }
-    if (auto obj = object.TryAs<String>()) {
-        return !(obj->GetValue().empty());
+    switch (object->GetType()) {
+        case Object::Type::Bool:
+            return static_cast<const Bool*>(object.Get())->GetValue();
+        case Object::Type::Number:
+            return static_cast<const Number*>(object.Get())->GetValue() != 0;
+        case Object::Type::String:
+            return !static_cast<const String*>(object.Get())->GetValue().empty();
+        default:
+            return false;
     }
-    return false;
 }
 
 void ClassInstance::Print(std::ostream& os, Context& context) {
-    if (this->HasMethod("__str__", 0)) {
-        this->Call("__str__", {}, context)->Print(os, context);
+    static const Symbol STR_METHOD{"__str__"};
+    if (this->HasMethod(STR_METHOD, 0)) {
+        this->Call(STR_METHOD, {}, context)->Print(os, context);
     } else {
         os << this;
     }
 }
 
-bool ClassInstance::HasMethod(const std::string& method, size_t argument_count) const {
+bool ClassInstance::HasMethod(Symbol method, size_t argument_count) const {
     return (cls_.GetMethod(method) && cls_.GetMethod(method)->formal_params.size() == argument_count);
 }
 
@@ -80,42 +387,72 @@ const Closure& ClassInstance::Fields() const {
     return fields_;
 }
 
-ClassInstance::ClassInstance(const Class& cls): cls_(cls) {
+ClassInstance::ClassInstance(const Class& cls): Object(Type::ClassInstance), cls_(cls) {
 }
 
-ObjectHolder ClassInstance::Call(const std::string& method,
+ObjectHolder ClassInstance::Call(Symbol method,
                                  const std::vector<ObjectHolder>& actual_args,
                                  Context& context) {
-    if (!this->HasMethod(method, actual_args.size())) {
+    return Call(method, actual_args.data(), actual_args.size(), context);
+}
+
+ObjectHolder ClassInstance::Call(Symbol method, const ObjectHolder* actual_args,
+                                 size_t argument_count, Context& context) {
+    if (!this->HasMethod(method, argument_count)) {
         throw std::runtime_error("Not implemented"s);
     }
-    
-    Closure closure = { {"self", ObjectHolder::Share(*this)} };
-    auto method_ptr = cls_.GetMethod(method);
-    
-    for (size_t i = 0; i < method_ptr->formal_params.size(); ++i) {
-        std::string arg = method_ptr->formal_params[i];
-        closure[arg] = actual_args[i];
+
+    return CallMethod(cls_.GetMethod(method), actual_args, argument_count, context);
+}
+
+ObjectHolder ClassInstance::CallMethod(const Method* method,
+                                       const std::vector<ObjectHolder>& actual_args,
+                                       Context& context) {
+    return CallMethod(method, actual_args.data(), actual_args.size(), context);
+}
+
+ObjectHolder ClassInstance::CallMethod(const Method* method, const ObjectHolder* actual_args,
+                                       [[maybe_unused]] size_t argument_count, Context& context) {
+    if (InstrumentationStats* stats = CurrentInstrumentation()) {
+        ++stats->method_calls[cls_.GetName() + "."s + method->name];
     }
-    
-    return method_ptr->body->Execute(closure, context);
+
+    assert(argument_count == method->formal_params.size());
+
+    if (method->native) {
+        // Нативный метод выполняется без кадра и таблицы имён:
+        // аргументы передаются C++-функции напрямую
+        return method->native(*this, actual_args, argument_count, context);
+    }
+
+    CallFrame frame;
+    Closure& closure = frame.GetClosure();
+    static const Symbol SELF{"self"};
+    closure[SELF] = ObjectHolder::Share(*this);
+
+    for (size_t i = 0; i < method->formal_params.size(); ++i) {
+        closure[method->formal_params[i]] = actual_args[i];
+    }
+
+    return method->body->Execute(closure, context);
 }
 
-Class::Class(std::string name, std::vector<Method> methods, const Class* parent): name_(std::move(name)),
+Class::Class(std::string name, std::vector<Method> methods, const Class* parent): Object(Type::Class),
+                                                                                  name_(std::move(name)),
                                                                                   methods_(std::move(methods)),
                                                                                   parent_(std::move(parent)) {
     if (parent_ != nullptr) {
         for (const auto& method : parent_->methods_) {
-            names_methods_[method.name] = &method;
+            names_methods_[Symbol{method.name}] = &method;
         }
     }
                                                                                       
     for (const auto& method : methods_) {
-        names_methods_[method.name] = &method;
+        names_methods_[Symbol{method.name}] = &method;
     }
 }
 
-const Method* Class::GetMethod(const std::string& name) const {
+const Method* Class::GetMethod(Symbol name) const {
     if (names_methods_.count(name) != 0) {
         return names_methods_.at(name);
     }
@@ -130,64 +467,177 @@ void Class::Print(ostream& os, [[maybe_unused]] Context& context) {
     os << "Class "s << GetName();
 }
 
+MethodCache::~MethodCache() {
+    const Entry* entry = head_.load(std::memory_order_relaxed);
+    while (entry != nullptr) {
+        const Entry* next = entry->next;
+        delete entry;
+        entry = next;
+    }
+}
+
+void MethodCache::Insert(const Class* cls, const Method* method) {
+    auto* entry = new Entry{cls, method, head_.load(std::memory_order_relaxed)};
+    // Запись публикуется добавлением в голову списка. При гонке двух потоков
+    // могут появиться дублирующие записи для одного класса - это безвредно
+    while (!head_.compare_exchange_weak(entry->next, entry, std::memory_order_release,
+                                        std::memory_order_relaxed)) {
+    }
+}
+
 void Bool::Print(std::ostream& os, [[maybe_unused]] Context& context) {
     os << (GetValue() ? "True"sv : "False"sv);
 }
 
-bool Equal(const ObjectHolder& lhs, const ObjectHolder& rhs, Context& context) {
-    if (lhs.TryAs<Number>() && rhs.TryAs<Number>()) {
-        return lhs.TryAs<Number>()->GetValue() == rhs.TryAs<Number>()->GetValue();
+ObjectHolder String::Concat(ObjectHolder&& lhs, const String& rhs) {
+    auto* lhs_str = lhs.TryAs<String>();
+    assert(lhs_str != nullptr);
+    // Дописывать на месте можно, только если и объект, и буфер принадлежат
+    // исключительно временному значению lhs: чужие строки не изменятся
+    if (lhs.IsSoleOwner() && lhs_str->value_.use_count() == 1) {
+        lhs_str->value_->append(rhs.GetValue());
+        return std::move(lhs);
+    }
+    std::string result;
+    result.reserve(lhs_str->GetValue().size() + rhs.GetValue().size());
+    result += lhs_str->GetValue();
+    result += rhs.GetValue();
+    return ObjectHolder::Own(String{std::move(result)});
+}
+
+namespace {
+
+// Трёхстороннее сравнение встроенных типов за один проход по тегам:
+// отрицательное значение - lhs меньше rhs, ноль - значения равны,
+// положительное - lhs больше rhs. nullopt - типы не сравнимы напрямую
+optional<int> CompareBuiltins(const ObjectHolder& lhs, const ObjectHolder& rhs) {
+    if (!lhs || !rhs || lhs->GetType() != rhs->GetType()) {
+        return nullopt;
+    }
+    switch (lhs->GetType()) {
+        case Object::Type::Number: {
+            const int l = static_cast<const Number*>(lhs.Get())->GetValue();
+            const int r = static_cast<const Number*>(rhs.Get())->GetValue();
+            return (l > r) - (l < r);
+        }
+        case Object::Type::String:
+            return static_cast<const String*>(lhs.Get())
+                ->GetValue()
+                .compare(static_cast<const String*>(rhs.Get())->GetValue());
+        case Object::Type::Bool: {
+            const bool l = static_cast<const Bool*>(lhs.Get())->GetValue();
+            const bool r = static_cast<const Bool*>(rhs.Get())->GetValue();
+            return static_cast<int>(l) - static_cast<int>(r);
+        }
+        default:
+            return nullopt;
+    }
+}
+
+// Вызывает пользовательский метод сравнения объекта object, если object -
+// экземпляр класса с подходящим методом. nullopt - метода нет
+optional<bool> CallUserComparison(const ObjectHolder& object, const Symbol& method,
+                                  const ObjectHolder& arg, Context& context) {
+    if (!object || object->GetType() != Object::Type::ClassInstance) {
+        return nullopt;
+    }
+    auto* instance = static_cast<ClassInstance*>(object.Get());
+    if (!instance->HasMethod(method, 1)) {
+        return nullopt;
+    }
+    return instance->Call(method, {arg}, context).TryAs<Bool>()->GetValue();
+}
+
+void CountComparison() {
+    if (InstrumentationStats* stats = CurrentInstrumentation()) {
+        ++stats->comparisons;
+    }
+}
+
+const Symbol EQ_METHOD{"__eq__"};
+const Symbol LT_METHOD{"__lt__"};
+
+// Реализация lhs > rhs. Если правый операнд определяет __lt__, достаточно
+// одного вызова rhs.__lt__(lhs); иначе применяется резервный протокол
+// из __lt__ и __eq__ левого операнда
+bool GreaterImpl(const ObjectHolder& lhs, const ObjectHolder& rhs, Context& context) {
+    if (const auto ordering = CompareBuiltins(lhs, rhs)) {
+        return *ordering > 0;
+    }
+    if (const auto swapped = CallUserComparison(rhs, LT_METHOD, lhs, context)) {
+        return *swapped;
     }
-    if (lhs.TryAs<String>() && rhs.TryAs<String>()) {
-        return lhs.TryAs<String>()->GetValue() == rhs.TryAs<String>()->GetValue();
+    if (const auto less = CallUserComparison(lhs, LT_METHOD, rhs, context)) {
+        if (*less) {
+            return false;
+        }
+        if (const auto equal = CallUserComparison(lhs, EQ_METHOD, rhs, context)) {
+            return !*equal;
+        }
+        throw std::runtime_error("Cannot compare objects for equality"s);
     }
-    if (lhs.TryAs<Bool>() && rhs.TryAs<Bool>()) {
-        return lhs.TryAs<Bool>()->GetValue() == rhs.TryAs<Bool>()->GetValue();
+    throw std::runtime_error("Cannot compare objects for less"s);
+}
+
+}  // namespace
+
+bool Equal(const ObjectHolder& lhs, const ObjectHolder& rhs, Context& context) {
+    CountComparison();
+    if (const auto ordering = CompareBuiltins(lhs, rhs)) {
+        return *ordering == 0;
     }
     if (!lhs && !rhs) {
         return true;
     }
-    if (lhs.TryAs<ClassInstance>() && lhs.TryAs<ClassInstance>()->HasMethod("__eq__", 1)) {
-        return lhs.TryAs<ClassInstance>()
-            ->Call("__eq__", {rhs}, context)
-            .TryAs<Bool>()
-            ->GetValue();
+    if (const auto result = CallUserComparison(lhs, EQ_METHOD, rhs, context)) {
+        return *result;
     }
     throw std::runtime_error("Cannot compare objects for equality"s);
 }
 
 bool Less(const ObjectHolder& lhs, const ObjectHolder& rhs, Context& context) {
-    if (lhs.TryAs<Number>() && rhs.TryAs<Number>()) {
-        return lhs.TryAs<Number>()->GetValue() < rhs.TryAs<Number>()->GetValue();
+    CountComparison();
+    if (const auto ordering = CompareBuiltins(lhs, rhs)) {
+        return *ordering < 0;
     }
-    if (lhs.TryAs<String>() && rhs.TryAs<String>()) {
-        return lhs.TryAs<String>()->GetValue() < rhs.TryAs<String>()->GetValue();
-    }
-    if (lhs.TryAs<Bool>() && rhs.TryAs<Bool>()) {
-        return lhs.TryAs<Bool>()->GetValue() < rhs.TryAs<Bool>()->GetValue();
-    }
-    if (lhs.TryAs<ClassInstance>() && lhs.TryAs<ClassInstance>()->HasMethod("__lt__", 1)) {
-        return lhs.TryAs<ClassInstance>()
-            ->Call("__lt__", {rhs}, context)
-            .TryAs<Bool>()
-            ->GetValue();
+    if (const auto result = CallUserComparison(lhs, LT_METHOD, rhs, context)) {
+        return *result;
     }
     throw std::runtime_error("Cannot compare objects for less"s);
 }
 
 bool NotEqual(const ObjectHolder& lhs, const ObjectHolder& rhs, Context& context) {
-    return !Equal(lhs, rhs, context);
+    CountComparison();
+    if (const auto ordering = CompareBuiltins(lhs, rhs)) {
+        return *ordering != 0;
+    }
+    if (lhs || rhs) {
+        if (const auto result = CallUserComparison(lhs, EQ_METHOD, rhs, context)) {
+            return !*result;
+        }
+        throw std::runtime_error("Cannot compare objects for equality"s);
+    }
+    return false;
 }
 
 bool Greater(const ObjectHolder& lhs, const ObjectHolder& rhs, Context& context) {
-    return !Less(lhs, rhs, context) && !Equal(lhs, rhs, context);
+    CountComparison();
+    return GreaterImpl(lhs, rhs, context);
 }
 
 bool LessOrEqual(const ObjectHolder& lhs, const ObjectHolder& rhs, Context& context) {
-    return !Greater(lhs, rhs, context);
+    CountComparison();
+    return !GreaterImpl(lhs, rhs, context);
 }
 
 bool GreaterOrEqual(const ObjectHolder& lhs, const ObjectHolder& rhs, Context& context) {
-    return !Less(lhs, rhs, context);
+    CountComparison();
+    if (const auto ordering = CompareBuiltins(lhs, rhs)) {
+        return *ordering >= 0;
+    }
+    if (const auto result = CallUserComparison(lhs, LT_METHOD, rhs, context)) {
+        return !*result;
+    }
+    throw std::runtime_error("Cannot compare objects for less"s);
 }
 }  // namespace runtime
\ No newline at end of file
@@ -1,19 +1,62 @@
 #pragma once
 
+#include "symbol.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
 #include <memory>
+#include <memory_resource>
+#include <stdexcept>
+#include <new>
 #include <sstream>
 #include <string>
+#include <type_traits>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace runtime {
 
+// Счётчики горячих путей интерпретатора. Заполняются, пока выполнение
+// идёт с InstrumentedContext; позволяют понять, какие методы и операции
+// программы нагружают процессор, не подключая внешний профилировщик
+struct InstrumentationStats {
+    // Выделения объектов в куче через ObjectHolder::Own
+    // (числа и логические значения размещаются на месте и не учитываются)
+    std::uint64_t allocations = 0;
+    // Сравнения значений функциями Equal и Less
+    std::uint64_t comparisons = 0;
+    // Вызовы методов по полному имени "Класс.метод"
+    std::unordered_map<std::string, std::uint64_t> method_calls;
+    // Выполненные операции по имени операции виртуальной машины
+    std::unordered_map<std::string, std::uint64_t> executed_ops;
+};
+
+// Возвращает счётчики текущего потока либо nullptr, если сбор выключен.
+// Когда сбор выключен, стоимость проверки - чтение указателя
+// и предсказуемый условный переход
+InstrumentationStats* CurrentInstrumentation();
+
 // Контекст исполнения инструкций Mython
 class Context {
 public:
     // Возвращает поток вывода для команд print
     virtual std::ostream& GetOutputStream() = 0;
 
+    // Возвращает счётчики инструментирования либо nullptr, если сбор выключен
+    virtual InstrumentationStats* GetInstrumentation() {
+        return nullptr;
+    }
+
+    // Возвращает буфер вывода для прямого форматирования значений либо
+    // nullptr, если контекст не буферизует вывод (см. BufferedContext)
+    virtual std::string* GetOutputBuffer() {
+        return nullptr;
+    }
+
 protected:
     ~Context() = default;
 };
@@ -21,23 +64,266 @@ protected:
 // Базовый класс для всех объектов языка Mython
 class Object {
 public:
+    // Тег типа объекта. Позволяет определять конкретный тип объекта
+    // одним сравнением, без обращения к RTTI
+    enum class Type : char {
+        Number,
+        String,
+        Bool,
+        Class,
+        ClassInstance,
+        // Прочие наследники Object (например, вспомогательные типы в тестах)
+        Other,
+    };
+
+    explicit Object(Type type = Type::Other)
+        : type_(type) {
+    }
     virtual ~Object() = default;
+
+    // Возвращает тег типа объекта
+    [[nodiscard]] Type GetType() const {
+        return type_;
+    }
+
     // выводит в os своё представление в виде строки
     virtual void Print(std::ostream& os, Context& context) = 0;
+
+private:
+    Type type_;
+};
+
+class Class;
+class ClassInstance;
+class Closure;
+
+/*
+ * Арена, из которой выделяется память под объекты Mython-программы.
+ * Выделение - продвижение указателя внутри крупных блоков, освобождение
+ * отдельных объектов не выполняется: вся память возвращается разом
+ * при разрушении арены или вызове Reset.
+ *
+ * Арена делается текущей с помощью ObjectArena::Scope; пока она текущая,
+ * ObjectHolder::Own размещает объекты в ней. Арену нельзя сбрасывать
+ * или разрушать, пока живы созданные из неё объекты
+ */
+class ObjectArena {
+public:
+    ObjectArena() = default;
+    ObjectArena(const ObjectArena&) = delete;
+    ObjectArena& operator=(const ObjectArena&) = delete;
+
+    // Возвращает ресурс памяти арены
+    std::pmr::memory_resource* GetResource() {
+        return &resource_;
+    }
+
+    // Освобождает всю память арены за O(1)
+    void Reset() {
+        // Слабые ссылки реестра указывают на блоки управления в памяти арены,
+        // поэтому освобождаются до самой памяти
+        tracked_instances_.clear();
+        resource_.release();
+    }
+
+    // Возвращает реестр экземпляров, созданных из арены (см. CycleCollector)
+    std::vector<std::weak_ptr<ClassInstance>>& TrackedInstances() {
+        return tracked_instances_;
+    }
+
+    // Делает арену текущей для потока на время своей жизни
+    class Scope {
+    public:
+        explicit Scope(ObjectArena& arena);
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+        ~Scope();
+
+    private:
+        ObjectArena* previous_;
+    };
+
+    // Возвращает текущую арену потока либо nullptr, если арена не установлена
+    static ObjectArena* Current();
+
+private:
+    std::pmr::monotonic_buffer_resource resource_;
+    // Реестр должен разрушаться раньше памяти арены,
+    // поэтому объявлен после resource_
+    std::vector<std::weak_ptr<ClassInstance>> tracked_instances_;
 };
 
+/*
+ * Коллектор циклов ссылок. Подсчёт ссылок shared_ptr не освобождает
+ * экземпляры, поля которых ссылаются друг на друга (self.next.prev = self),
+ * поэтому каждый созданный экземпляр регистрируется слабой ссылкой,
+ * а CollectCycles помечает экземпляры, достижимые из корневых таблиц имён,
+ * и очищает поля недостижимых. Разорванные циклы дальше освобождает
+ * обычный подсчёт ссылок.
+ *
+ * Реестр принадлежит текущей арене потока (или самому потоку, если арена
+ * не установлена), поэтому программы в разных потоках собираются независимо
+ */
+class CycleCollector {
+public:
+    // Регистрирует созданный экземпляр. Вызывается из ObjectHolder::Own
+    static void Track(const std::shared_ptr<ClassInstance>& instance);
+
+    /*
+     * Разрывает циклы среди зарегистрированных экземпляров, недостижимых
+     * ни из одной из таблиц roots. Возвращает число собранных экземпляров.
+     *
+     * Вызывать допустимо только в точках, где roots покрывают все живые
+     * ссылки на экземпляры: между инструкциями верхнего уровня
+     * или по завершении программы
+     */
+    static size_t CollectCycles(std::initializer_list<const Closure*> roots);
+
+private:
+    // Возвращает реестр экземпляров текущей арены потока
+    // либо запасной реестр потока, если арена не установлена
+    static std::vector<std::weak_ptr<ClassInstance>>& Registry();
+};
+
+// Объект-значение, хранящий значение типа T
+template <typename T>
+class ValueObject : public Object {
+public:
+    ValueObject(T v)  // NOLINT(google-explicit-constructor,hicpp-explicit-conversions)
+        : Object(TypeTag())
+        , value_(v) {
+    }
+
+    void Print(std::ostream& os, [[maybe_unused]] Context& context) override {
+        os << value_;
+    }
+
+    [[nodiscard]] const T& GetValue() const {
+        return value_;
+    }
+
+private:
+    // Возвращает тег типа объекта-значения
+    static constexpr Type TypeTag() {
+        if constexpr (std::is_same_v<T, int>) {
+            return Type::Number;
+        } else if constexpr (std::is_same_v<T, bool>) {
+            return Type::Bool;
+        } else {
+            return Type::Other;
+        }
+    }
+
+    T value_;
+};
+
+class ObjectHolder;
+
+/*
+ * Строковое значение. Символы хранятся в разделяемом неизменяемом буфере:
+ * копирование строки копирует лишь указатель на буфер, поэтому одинаковые
+ * литералы и результаты str могут разделять одну последовательность символов
+ */
+class String : public Object {
+public:
+    String(std::string v)  // NOLINT(google-explicit-constructor,hicpp-explicit-conversions)
+        : Object(Type::String)
+        , value_(std::make_shared<std::string>(std::move(v))) {
+    }
+
+    void Print(std::ostream& os, [[maybe_unused]] Context& context) override {
+        os << *value_;
+    }
+
+    [[nodiscard]] const std::string& GetValue() const {
+        return *value_;
+    }
+
+    /*
+     * Возвращает конкатенацию строки в lhs и строки rhs. Если lhs - временное
+     * значение, единолично владеющее и объектом, и его буфером, rhs
+     * дописывается в буфер на месте: благодаря экспоненциальному росту
+     * ёмкости свёртка N фрагментов выполняется за O(N) копирований символов.
+     * lhs должен содержать значение типа String
+     */
+    static ObjectHolder Concat(ObjectHolder&& lhs, const String& rhs);
+
+private:
+    std::shared_ptr<std::string> value_;
+};
+
+// Числовое значение
+using Number = ValueObject<int>;
+
+// Логическое значение
+class Bool : public ValueObject<bool> {
+public:
+    using ValueObject<bool>::ValueObject;
+
+    void Print(std::ostream& os, Context& context) override;
+};
+
+// Возвращает тег, соответствующий типу T, либо Object::Type::Other,
+// если T не является типом языка Mython
+template <typename T>
+constexpr Object::Type TypeTagOf() {
+    if constexpr (std::is_same_v<T, Number>) {
+        return Object::Type::Number;
+    } else if constexpr (std::is_same_v<T, String>) {
+        return Object::Type::String;
+    } else if constexpr (std::is_same_v<T, Bool>) {
+        return Object::Type::Bool;
+    } else if constexpr (std::is_same_v<T, Class>) {
+        return Object::Type::Class;
+    } else if constexpr (std::is_same_v<T, ClassInstance>) {
+        return Object::Type::ClassInstance;
+    } else {
+        return Object::Type::Other;
+    }
+}
+
 // Специальный класс-обёртка, предназначенный для хранения объекта в Mython-программе
 class ObjectHolder {
 public:
     // Создаёт пустое значение
     ObjectHolder() = default;
+    ObjectHolder(const ObjectHolder& other);
+    ObjectHolder(ObjectHolder&& other) noexcept;
+    ObjectHolder& operator=(const ObjectHolder& other);
+    ObjectHolder& operator=(ObjectHolder&& other) noexcept;
+    ~ObjectHolder();
 
     // Возвращает ObjectHolder, владеющий объектом типа T
     // Тип T - конкретный класс-наследник Object.
-    // object копируется или перемещается в кучу
+    // Числа и логические значения размещаются внутри самого ObjectHolder,
+    // без выделения памяти в куче. Остальные объекты копируются
+    // или перемещаются в кучу
     template <typename T>
     [[nodiscard]] static ObjectHolder Own(T&& object) {
-        return ObjectHolder(std::make_shared<T>(std::forward<T>(object)));
+        using Value = std::remove_reference_t<T>;
+        if constexpr (std::is_same_v<Value, Number> || std::is_same_v<Value, Bool>) {
+            ObjectHolder holder;
+            holder.EmplaceInline(object);
+            return holder;
+        } else {
+            if (InstrumentationStats* stats = CurrentInstrumentation()) {
+                ++stats->allocations;
+            }
+            std::shared_ptr<Value> data;
+            if (ObjectArena* arena = ObjectArena::Current()) {
+                data = std::allocate_shared<Value>(
+                    std::pmr::polymorphic_allocator<Value>(arena->GetResource()),
+                    std::forward<T>(object));
+            } else {
+                data = std::make_shared<Value>(std::forward<T>(object));
+            }
+            if constexpr (std::is_same_v<Value, ClassInstance>) {
+                // Экземпляры классов могут образовывать циклы ссылок
+                // и отслеживаются коллектором циклов
+                CycleCollector::Track(data);
+            }
+            return ObjectHolder(std::move(data));
+        }
     }
 
     // Создаёт ObjectHolder, не владеющий объектом (аналог слабой ссылки)
@@ -57,41 +343,201 @@ public:
     // объект данного типа
     template <typename T>
     [[nodiscard]] T* TryAs() const {
-        return dynamic_cast<T*>(this->Get());
+        Object* object = this->Get();
+        if constexpr (TypeTagOf<T>() != Object::Type::Other) {
+            // Типы языка различаются сравнением тега, без обращения к RTTI
+            if (object != nullptr && object->GetType() == TypeTagOf<T>()) {
+                return static_cast<T*>(object);
+            }
+            return nullptr;
+        } else {
+            return dynamic_cast<T*>(object);
+        }
     }
 
     // Возвращает true, если ObjectHolder не пуст
     explicit operator bool() const;
 
+    // Возвращает true, если *this - единственный владелец объекта в куче.
+    // Для пустых, встроенных и невладеющих (Share) значений возвращает false
+    [[nodiscard]] bool IsSoleOwner() const;
+
 private:
+    // Способ хранения объекта: числа и логические значения лежат
+    // во внутреннем буфере, владеемые объекты - в куче за shared_ptr,
+    // невладеющая ссылка (Share) - простой помеченный указатель
+    enum class Storage : char {
+        Empty,
+        InlineNumber,
+        InlineBool,
+        Shared,
+        Borrowed,
+    };
+
     explicit ObjectHolder(std::shared_ptr<Object> data);
     void AssertIsValid() const;
 
+    void EmplaceInline(const Number& value);
+    void EmplaceInline(const Bool& value);
+    // Копирует содержимое other; *this должен быть пустым
+    void CopyFrom(const ObjectHolder& other);
+    // Возвращает *this в пустое состояние, разрушая объект во внутреннем буфере
+    void Reset();
+
+    [[nodiscard]] Object* GetInline() const;
+
     std::shared_ptr<Object> data_;
+    // Невладеющая ссылка: объект живёт дольше холдера, блок управления
+    // и атомарный счётчик ссылок не нужны
+    Object* borrowed_ = nullptr;
+    std::aligned_union_t<0, Number, Bool> inline_data_;
+    Storage storage_ = Storage::Empty;
 };
 
-// Объект-значение, хранящий значение типа T
-template <typename T>
-class ValueObject : public Object {
+/*
+ * Таблица символов, связывающая имя объекта с его значением.
+ *
+ * Реализована плоским массивом слотов, а не хеш-таблицей: кадр вызова
+ * метода содержит лишь self, параметры и несколько локальных переменных,
+ * поэтому линейный просмотр интернированных символов (сравнение маленьких
+ * целых) быстрее хеширования и не требует выделения памяти под корзины.
+ * Интерфейс повторяет используемое подмножество std::unordered_map
+ */
+class Closure {
 public:
-    ValueObject(T v)  // NOLINT(google-explicit-constructor,hicpp-explicit-conversions)
-        : value_(v) {
+    // Слот таблицы: имя и связанное с ним значение
+    using value_type = std::pair<Symbol, ObjectHolder>;
+    using iterator = std::vector<value_type>::iterator;
+    using const_iterator = std::vector<value_type>::const_iterator;
+
+    Closure() = default;
+    Closure(std::initializer_list<value_type> values) {
+        slots_.reserve(values.size());
+        for (auto& value : values) {
+            (*this)[value.first] = value.second;
+        }
     }
 
-    void Print(std::ostream& os, [[maybe_unused]] Context& context) override {
-        os << value_;
+    // Возвращает ссылку на значение имени name, при необходимости создавая
+    // для него пустой слот
+    ObjectHolder& operator[](Symbol name) {
+        if (auto it = find(name); it != slots_.end()) {
+            return it->second;
+        }
+        slots_.emplace_back(name, ObjectHolder{});
+        return slots_.back().second;
     }
 
-    [[nodiscard]] const T& GetValue() const {
-        return value_;
+    // Возвращает ссылку на значение имени name.
+    // Если имя отсутствует, выбрасывает std::out_of_range
+    [[nodiscard]] ObjectHolder& at(Symbol name) {
+        if (auto it = find(name); it != slots_.end()) {
+            return it->second;
+        }
+        throw std::out_of_range("No value for name " + name.GetName());
+    }
+
+    [[nodiscard]] const ObjectHolder& at(Symbol name) const {
+        if (auto it = find(name); it != slots_.end()) {
+            return it->second;
+        }
+        throw std::out_of_range("No value for name " + name.GetName());
+    }
+
+    [[nodiscard]] iterator find(Symbol name) {
+        return std::find_if(slots_.begin(), slots_.end(),
+                            [name](const value_type& slot) { return slot.first == name; });
+    }
+
+    [[nodiscard]] const_iterator find(Symbol name) const {
+        return std::find_if(slots_.begin(), slots_.end(),
+                            [name](const value_type& slot) { return slot.first == name; });
+    }
+
+    // Добавляет значение, если имя ещё не занято.
+    // Возвращает слот имени и признак того, что вставка произошла
+    std::pair<iterator, bool> insert(value_type value) {
+        if (auto it = find(value.first); it != slots_.end()) {
+            return {it, false};
+        }
+        slots_.push_back(std::move(value));
+        return {std::prev(slots_.end()), true};
+    }
+
+    [[nodiscard]] size_t count(Symbol name) const {
+        return find(name) != slots_.end() ? 1 : 0;
+    }
+
+    [[nodiscard]] iterator begin() {
+        return slots_.begin();
+    }
+    [[nodiscard]] iterator end() {
+        return slots_.end();
+    }
+    [[nodiscard]] const_iterator begin() const {
+        return slots_.begin();
+    }
+    [[nodiscard]] const_iterator end() const {
+        return slots_.end();
+    }
+
+    [[nodiscard]] size_t size() const {
+        return slots_.size();
+    }
+    [[nodiscard]] bool empty() const {
+        return slots_.empty();
+    }
+    void clear() {
+        slots_.clear();
+    }
+    // Заранее резервирует место под count слотов
+    void reserve(size_t count) {
+        slots_.reserve(count);
     }
 
 private:
-    T value_;
+    std::vector<value_type> slots_;
 };
 
-// Таблица символов, связывающая имя объекта с его значением
-using Closure = std::unordered_map<std::string, ObjectHolder>;
+/*
+ * Кадр вызова метода, взятый из пула кадров потока. Содержит Closure
+ * для self и параметров, а также буфер фактических аргументов вызова.
+ * При разрушении кадр возвращается в пул, поэтому его слоты и буфер
+ * переиспользуются следующими вызовами: глубокая рекурсия не строит
+ * и не разрушает таблицы имён на каждом вызове
+ */
+class CallFrame {
+public:
+    CallFrame();
+    CallFrame(const CallFrame&) = delete;
+    CallFrame& operator=(const CallFrame&) = delete;
+    ~CallFrame();
+
+    // Возвращает таблицу имён кадра
+    [[nodiscard]] Closure& GetClosure() {
+        return frame_->closure;
+    }
+
+    // Возвращает буфер фактических аргументов кадра
+    [[nodiscard]] std::vector<ObjectHolder>& GetArgs() {
+        return frame_->args;
+    }
+
+private:
+    struct Frame {
+        Closure closure;
+        std::vector<ObjectHolder> args;
+    };
+
+    // Берёт свободный кадр из пула потока либо создаёт новый
+    static std::unique_ptr<Frame> Acquire();
+    // Возвращает кадр в пул потока
+    static void Release(std::unique_ptr<Frame> frame);
+    // Возвращает пул свободных кадров текущего потока
+    static std::vector<std::unique_ptr<Frame>>& FreeFrames();
+
+    std::unique_ptr<Frame> frame_;
+};
 
 // Проверяет, содержится ли в object значение, приводимое к True
 // Для отличных от нуля чисел, True и непустых строк возвращается true. В остальных случаях - false.
@@ -106,27 +552,25 @@ public:
     virtual ObjectHolder Execute(Closure& closure, Context& context) = 0;
 };
 
-// Строковое значение
-using String = ValueObject<std::string>;
-// Числовое значение
-using Number = ValueObject<int>;
-
-// Логическое значение
-class Bool : public ValueObject<bool> {
-public:
-    using ValueObject<bool>::ValueObject;
-
-    void Print(std::ostream& os, Context& context) override;
-};
+/*
+ * Сигнатура нативного (C++) метода: self - объект-получатель вызова,
+ * [args, args + count) - фактические аргументы, context - контекст выполнения.
+ * Возвращаемое значение становится результатом вызова метода
+ */
+using NativeFunction = std::function<ObjectHolder(
+    ClassInstance& self, const ObjectHolder* args, size_t count, Context& context)>;
 
 // Метод класса
 struct Method {
     // Имя метода
     std::string name;
     // Имена формальных параметров метода
-    std::vector<std::string> formal_params;
-    // Тело метода
+    std::vector<Symbol> formal_params;
+    // Тело метода либо nullptr, если метод нативный
     std::unique_ptr<Executable> body;
+    // Нативная реализация: если задана, вызывается вместо body.
+    // Избавляет горячие вспомогательные функции от интерпретации
+    NativeFunction native = {};
 };
 
 // Класс
@@ -137,7 +581,21 @@ public:
     explicit Class(std::string name, std::vector<Method> methods, const Class* parent);
 
     // Возвращает указатель на метод name или nullptr, если метод с таким именем отсутствует
-    [[nodiscard]] const Method* GetMethod(const std::string& name) const;
+    [[nodiscard]] const Method* GetMethod(Symbol name) const;
+
+    // Возвращает собственные методы класса. Изменять допустимо только тела
+    // методов: используется проходом оптимизации для упрощения их деревьев
+    std::vector<Method>& GetMethods() {
+        return methods_;
+    }
+    // Возвращает собственные методы класса
+    [[nodiscard]] const std::vector<Method>& GetMethods() const {
+        return methods_;
+    }
+    // Возвращает родительский класс либо nullptr для базового класса
+    [[nodiscard]] const Class* GetParent() const {
+        return parent_;
+    }
 
     // Возвращает имя класса
     [[nodiscard]] const std::string& GetName() const;
@@ -146,12 +604,54 @@ public:
     void Print(std::ostream& os, Context& context) override;
     
 private:
-    std::unordered_map<std::string, const Method*> names_methods_;
+    std::unordered_map<Symbol, const Method*> names_methods_;
 	std::string name_;
 	std::vector<Method> methods_;
 	const Class* parent_ = nullptr;
 };
 
+/*
+ * Инлайн-кэш точки вызова метода: класс объекта в конкретной точке вызова
+ * почти никогда не меняется, поэтому результат поиска метода по имени
+ * запоминается и переиспользуется. Записи неизменяемы и публикуются
+ * атомарно в виде односвязного списка, поэтому кэш безопасно читать
+ * и пополнять из нескольких потоков, выполняющих общий образ программы
+ */
+class MethodCache {
+public:
+    MethodCache() = default;
+    MethodCache(MethodCache&& other) noexcept
+        : head_(other.head_.exchange(nullptr, std::memory_order_relaxed)) {
+    }
+    MethodCache(const MethodCache&) = delete;
+    MethodCache& operator=(const MethodCache&) = delete;
+    ~MethodCache();
+
+    // Возвращает закэшированный метод класса cls либо nullptr,
+    // если записи для этого класса ещё нет
+    [[nodiscard]] const Method* Lookup(const Class* cls) const {
+        for (const Entry* entry = head_.load(std::memory_order_acquire); entry != nullptr;
+             entry = entry->next) {
+            if (entry->cls == cls) {
+                return entry->method;
+            }
+        }
+        return nullptr;
+    }
+
+    // Запоминает соответствие cls -> method
+    void Insert(const Class* cls, const Method* method);
+
+private:
+    struct Entry {
+        const Class* cls;
+        const Method* method;
+        const Entry* next;
+    };
+
+    std::atomic<const Entry*> head_{nullptr};
+};
+
 // Экземпляр класса
 class ClassInstance : public Object {
 public:
@@ -169,11 +669,33 @@ public:
      * Если ни сам класс, ни его родители не содержат метод method, метод выбрасывает исключение
      * runtime_error
      */
-    ObjectHolder Call(const std::string& method, const std::vector<ObjectHolder>& actual_args,
+    ObjectHolder Call(Symbol method, const std::vector<ObjectHolder>& actual_args,
                       Context& context);
 
+    // Перегрузка Call, принимающая аргументы диапазоном [actual_args, actual_args + argument_count)
+    ObjectHolder Call(Symbol method, const ObjectHolder* actual_args, size_t argument_count,
+                      Context& context);
+
+    /*
+     * Вызывает уже разрешённый метод method, минуя поиск по имени.
+     * Указатель method должен быть получен из GetClass().GetMethod(...)
+     * и принимать actual_args.size() параметров
+     */
+    ObjectHolder CallMethod(const Method* method, const std::vector<ObjectHolder>& actual_args,
+                            Context& context);
+
+    // Перегрузка CallMethod, принимающая аргументы диапазоном
+    // [actual_args, actual_args + argument_count)
+    ObjectHolder CallMethod(const Method* method, const ObjectHolder* actual_args,
+                            size_t argument_count, Context& context);
+
     // Возвращает true, если объект имеет метод method, принимающий argument_count параметров
-    [[nodiscard]] bool HasMethod(const std::string& method, size_t argument_count) const;
+    [[nodiscard]] bool HasMethod(Symbol method, size_t argument_count) const;
+
+    // Возвращает класс объекта
+    [[nodiscard]] const Class& GetClass() const {
+        return cls_;
+    }
 
     // Возвращает ссылку на Closure, содержащий поля объекта
     [[nodiscard]] Closure& Fields();
@@ -213,6 +735,21 @@ bool LessOrEqual(const ObjectHolder& lhs, const ObjectHolder& rhs, Context& cont
 // Возвращает значение, противоположное Less(lhs, rhs, context)
 bool GreaterOrEqual(const ObjectHolder& lhs, const ObjectHolder& rhs, Context& context);
 
+/*
+ * Выводит значение value (либо None для пустого значения) в вывод
+ * контекста. Числа, строки и логические значения записываются в буфер
+ * BufferedContext напрямую, без виртуальных вызовов потока; остальные
+ * значения выводятся методом Print
+ */
+void PrintValue(const ObjectHolder& value, Context& context);
+
+/*
+ * Возвращает строковое представление значения value.
+ * Числа, строки и логические значения форматируются без ostringstream;
+ * для остальных значений используется их метод Print
+ */
+ObjectHolder ToString(const ObjectHolder& value, Context& context);
+
 // Контекст-заглушка, применяется в тестах.
 // В этом контексте весь вывод перенаправляется в строковый поток вывода output
 struct DummyContext : Context {
@@ -238,4 +775,96 @@ private:
     std::ostream& output_;
 };
 
+/*
+ * Контекст с буферизацией вывода: команды print накапливают вывод
+ * в строковом буфере, который записывается в нижележащий поток одним
+ * вызовом Flush (и при разрушении контекста). Под нагрузкой это заменяет
+ * виртуальные вызовы потока на каждое значение дописыванием в строку
+ */
+class BufferedContext : public Context {
+public:
+    explicit BufferedContext(std::ostream& output)
+        : output_(output)
+        , sink_(buffer_)
+        , stream_(&sink_) {
+    }
+    BufferedContext(const BufferedContext&) = delete;
+    BufferedContext& operator=(const BufferedContext&) = delete;
+    ~BufferedContext() {
+        Flush();
+    }
+
+    std::ostream& GetOutputStream() override {
+        return stream_;
+    }
+
+    std::string* GetOutputBuffer() override {
+        return &buffer_;
+    }
+
+    // Записывает накопленный вывод в нижележащий поток и очищает буфер
+    void Flush() {
+        if (!buffer_.empty()) {
+            output_.write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+            buffer_.clear();
+        }
+    }
+
+private:
+    // Поточный буфер, дописывающий всё записанное в строку
+    class BufferSink : public std::streambuf {
+    public:
+        explicit BufferSink(std::string& buffer)
+            : buffer_(buffer) {
+        }
+
+    protected:
+        int_type overflow(int_type ch) override {
+            if (ch != traits_type::eof()) {
+                buffer_.push_back(static_cast<char>(ch));
+            }
+            return ch;
+        }
+
+        std::streamsize xsputn(const char* data, std::streamsize count) override {
+            buffer_.append(data, static_cast<size_t>(count));
+            return count;
+        }
+
+    private:
+        std::string& buffer_;
+    };
+
+    std::ostream& output_;
+    std::string buffer_;
+    BufferSink sink_;
+    std::ostream stream_;
+};
+
+/*
+ * Контекст со сбором счётчиков горячих путей. На время своей жизни делает
+ * счётчики текущими для потока (по образцу ObjectArena::Scope), чтобы их
+ * могли пополнять и пути без доступа к Context, например ObjectHolder::Own
+ */
+class InstrumentedContext : public Context {
+public:
+    explicit InstrumentedContext(std::ostream& output);
+    InstrumentedContext(const InstrumentedContext&) = delete;
+    InstrumentedContext& operator=(const InstrumentedContext&) = delete;
+    ~InstrumentedContext();
+
+    std::ostream& GetOutputStream() override {
+        return output_;
+    }
+
+    InstrumentationStats* GetInstrumentation() override {
+        return &stats_;
+    }
+
+private:
+    std::ostream& output_;
+    InstrumentationStats stats_;
+    InstrumentationStats* previous_;
+};
+
 }  // namespace runtime
\ No newline at end of file
@@ -19,13 +19,15 @@ public:
     }
 
     Logger(const Logger& rhs)
-        : id_(rhs.id_)  //
+        : Object(rhs)
+        , id_(rhs.id_)  //
     {
         ++instance_count;
     }
 
     Logger(Logger&& rhs) noexcept
-        : id_(rhs.id_)  //
+        : Object(rhs)
+        , id_(rhs.id_)  //
     {
         ++instance_count;
     }
@@ -529,8 +531,132 @@ void TestClassInstance() {
     ASSERT_THROWS(instance.Call("missing_method"s, {}, ctx), runtime_error);
 }
 
+void TestArena() {
+    ASSERT(ObjectArena::Current() == nullptr);
+    {
+        ObjectArena arena;
+        ObjectArena::Scope scope{arena};
+        ASSERT(ObjectArena::Current() == &arena);
+
+        auto oh = ObjectHolder::Own(String{"stored in arena"s});
+        ASSERT(oh);
+        ASSERT_EQUAL(oh.TryAs<String>()->GetValue(), "stored in arena"s);
+    }
+    // После выхода из Scope арена перестаёт быть текущей
+    ASSERT(ObjectArena::Current() == nullptr);
+}
+
+void TestCycleCollector() {
+    ObjectArena arena;
+    ObjectArena::Scope scope{arena};
+
+    Class cls{"Node"s, {}, nullptr};
+    Closure root;
+    root["a"s] = ObjectHolder::Own(ClassInstance{cls});
+    root["b"s] = ObjectHolder::Own(ClassInstance{cls});
+
+    auto* a = root.at("a"s).TryAs<ClassInstance>();
+    auto* b = root.at("b"s).TryAs<ClassInstance>();
+    a->Fields()["next"s] = root.at("b"s);
+    b->Fields()["prev"s] = root.at("a"s);
+
+    // Достижимые из корня экземпляры коллектор не трогает
+    ASSERT_EQUAL(CycleCollector::CollectCycles({&root}), 0U);
+    ASSERT_EQUAL(a->Fields().count("next"s), 1U);
+    ASSERT_EQUAL(b->Fields().count("prev"s), 1U);
+
+    // Цикл a <-> b без внешних ссылок не освобождается подсчётом ссылок,
+    // но обнаруживается и разрывается коллектором
+    root.clear();
+    ASSERT_EQUAL(CycleCollector::CollectCycles({}), 2U);
+    ASSERT_EQUAL(CycleCollector::CollectCycles({}), 0U);
+}
+
 }  // namespace
 
+void TestInstrumentation() {
+    // Без InstrumentedContext сбор счётчиков выключен
+    ASSERT(CurrentInstrumentation() == nullptr);
+
+    ostringstream output;
+    {
+        InstrumentedContext context{output};
+        ASSERT(context.GetInstrumentation() == CurrentInstrumentation());
+
+        auto str = ObjectHolder::Own(String{"counted"s});
+        auto num = ObjectHolder::Own(Number{1});
+        Equal(num, num, context);
+        Less(num, num, context);
+
+        auto method_body = [](Closure& /*closure*/, Context& /*ctx*/) {
+            return ObjectHolder::Own(Number{42});
+        };
+        vector<Method> methods;
+        methods.push_back(Method{"value"s, {}, make_unique<TestMethodBody>(method_body)});
+        Class cls{"Counted"s, std::move(methods), nullptr};
+        ClassInstance instance{cls};
+        instance.Call("value"s, {}, context);
+        instance.Call("value"s, {}, context);
+
+        const auto* stats = context.GetInstrumentation();
+        // Числа размещаются на месте - выделение в куче только у строки
+        ASSERT_EQUAL(stats->allocations, 1U);
+        ASSERT_EQUAL(stats->comparisons, 2U);
+        ASSERT_EQUAL(stats->method_calls.at("Counted.value"s), 2U);
+    }
+    ASSERT(CurrentInstrumentation() == nullptr);
+}
+
+void TestStringConcat() {
+    // Копии строки разделяют один буфер символов
+    String original{"abc"s};
+    String copy = original;  // NOLINT(performance-unnecessary-copy-initialization)
+    ASSERT(&original.GetValue() == &copy.GetValue());
+
+    // Конкатенация не изменяет строку, на которую ссылается переменная
+    auto stored = ObjectHolder::Own(String{"head"s});
+    auto lhs = stored;
+    auto result = String::Concat(std::move(lhs), String{"+tail"s});
+    ASSERT_EQUAL(result.TryAs<String>()->GetValue(), "head+tail"s);
+    ASSERT_EQUAL(stored.TryAs<String>()->GetValue(), "head"s);
+
+    // Свёртка фрагментов через временные значения даёт ту же строку
+    auto accumulated = ObjectHolder::Own(String{""s});
+    for (int i = 0; i < 3; ++i) {
+        accumulated = String::Concat(std::move(accumulated), String{"ab"s});
+    }
+    ASSERT_EQUAL(accumulated.TryAs<String>()->GetValue(), "ababab"s);
+}
+
+void TestBufferedContext() {
+    ostringstream output;
+    {
+        BufferedContext context{output};
+
+        PrintValue(ObjectHolder::Own(Number{-42}), context);
+        context.GetOutputStream() << ' ';
+        PrintValue(ObjectHolder::Own(String{"str"s}), context);
+        context.GetOutputStream() << ' ';
+        PrintValue(ObjectHolder::Own(Bool{true}), context);
+        context.GetOutputStream() << ' ';
+        PrintValue(ObjectHolder::None(), context);
+
+        // До вызова Flush вывод накапливается в буфере
+        ASSERT_EQUAL(output.str(), ""s);
+        context.Flush();
+        ASSERT_EQUAL(output.str(), "-42 str True None"s);
+
+        context.GetOutputStream() << "more"s;
+    }
+    // Разрушение контекста записывает остаток буфера
+    ASSERT_EQUAL(output.str(), "-42 str True None"s + "more"s);
+
+    DummyContext plain;
+    auto str = ToString(ObjectHolder::Own(Number{7}), plain);
+    ASSERT_EQUAL(str.TryAs<String>()->GetValue(), "7"s);
+    ASSERT_EQUAL(ToString(ObjectHolder::None(), plain).TryAs<String>()->GetValue(), "None"s);
+}
+
 void RunObjectsTests(TestRunner& tr) {
     RUN_TEST(tr, runtime::TestNumber);
     RUN_TEST(tr, runtime::TestString);
@@ -540,6 +666,9 @@ void RunObjectsTests(TestRunner& tr) {
     RUN_TEST(tr, runtime::TestComparison);
     RUN_TEST(tr, runtime::TestClass);
     RUN_TEST(tr, runtime::TestClassInstance);
+    RUN_TEST(tr, runtime::TestInstrumentation);
+    RUN_TEST(tr, runtime::TestStringConcat);
+    RUN_TEST(tr, runtime::TestBufferedContext);
 }
 
 void RunObjectHolderTests(TestRunner& tr) {
@@ -547,6 +676,8 @@ void RunObjectHolderTests(TestRunner& tr) {
     RUN_TEST(tr, runtime::TestOwning);
     RUN_TEST(tr, runtime::TestMove);
     RUN_TEST(tr, runtime::TestNullptr);
+    RUN_TEST(tr, runtime::TestArena);
+    RUN_TEST(tr, runtime::TestCycleCollector);
 }
 
 }  // namespace runtime
\ No newline at end of file
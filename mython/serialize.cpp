@@ -0,0 +1,555 @@
+#include "serialize.h"
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+namespace ast {
+
+namespace {
+
+// Сигнатура и версия формата. Версия увеличивается при любом изменении
+// набора узлов или их представления
+constexpr uint32_t FORMAT_MAGIC = 0x4359'424D;  // "MBYC"
+constexpr uint32_t FORMAT_VERSION = 3;
+
+// Тег типа узла дерева. Нулевой тег кодирует отсутствующий узел
+// (например, пустую ветку else)
+enum class NodeTag : uint8_t {
+    Absent = 0,
+    NumericConst,
+    StringConst,
+    BoolConst,
+    NoneValue,
+    Variable,
+    Assign,
+    FieldAssign,
+    PrintStatement,
+    Call,
+    New,
+    Str,
+    LogicalNot,
+    AddOp,
+    SubOp,
+    MultOp,
+    DivOp,
+    OrOp,
+    AndOp,
+    CompoundBlock,
+    Body,
+    ReturnStatement,
+    ClassDef,
+    IfStatement,
+    Compare,
+    WhileStatement,
+    FieldAddAssignStatement,
+    CompareBranchStatement,
+};
+
+// Тип функции сравнения, передаваемой в ast::Comparison
+using ComparatorFn = bool (*)(const runtime::ObjectHolder&, const runtime::ObjectHolder&,
+                              runtime::Context&);
+
+// Функции сравнения в порядке их тегов в формате
+const ComparatorFn COMPARATORS[] = {
+    runtime::Equal,       runtime::NotEqual,    runtime::Less,
+    runtime::Greater,     runtime::LessOrEqual, runtime::GreaterOrEqual,
+};
+
+void WriteU8(ostream& os, uint8_t value) {
+    os.put(static_cast<char>(value));
+}
+
+void WriteU32(ostream& os, uint32_t value) {
+    for (int shift = 0; shift < 32; shift += 8) {
+        os.put(static_cast<char>((value >> shift) & 0xFF));
+    }
+}
+
+void WriteI32(ostream& os, int value) {
+    WriteU32(os, static_cast<uint32_t>(value));
+}
+
+void WriteString(ostream& os, const string& value) {
+    WriteU32(os, static_cast<uint32_t>(value.size()));
+    os.write(value.data(), static_cast<streamsize>(value.size()));
+}
+
+uint8_t ReadU8(istream& is) {
+    const int value = is.get();
+    if (value == char_traits<char>::eof()) {
+        throw runtime_error("Unexpected end of serialized program"s);
+    }
+    return static_cast<uint8_t>(value);
+}
+
+uint32_t ReadU32(istream& is) {
+    uint32_t value = 0;
+    for (int shift = 0; shift < 32; shift += 8) {
+        value |= static_cast<uint32_t>(ReadU8(is)) << shift;
+    }
+    return value;
+}
+
+int ReadI32(istream& is) {
+    return static_cast<int>(ReadU32(is));
+}
+
+string ReadString(istream& is) {
+    const uint32_t size = ReadU32(is);
+    string value(size, '\0');
+    is.read(value.data(), static_cast<streamsize>(size));
+    if (!is) {
+        throw runtime_error("Unexpected end of serialized program"s);
+    }
+    return value;
+}
+
+// Записывает дерево программы, нумеруя объявляемые классы в порядке
+// появления: ссылки на классы кодируются их номерами
+class Saver {
+public:
+    explicit Saver(ostream& os)
+        : os_(os) {
+    }
+
+    void SaveNode(const Statement* node) {  // NOLINT
+        if (node == nullptr) {
+            WriteU8(os_, static_cast<uint8_t>(NodeTag::Absent));
+            return;
+        }
+        if (const auto* numeric = dynamic_cast<const NumericConst*>(node)) {
+            WriteTag(NodeTag::NumericConst);
+            WriteI32(os_, numeric->GetValue().GetValue());
+            return;
+        }
+        if (const auto* str = dynamic_cast<const StringConst*>(node)) {
+            WriteTag(NodeTag::StringConst);
+            WriteString(os_, str->GetValue().GetValue());
+            return;
+        }
+        if (const auto* boolean = dynamic_cast<const BoolConst*>(node)) {
+            WriteTag(NodeTag::BoolConst);
+            WriteU8(os_, boolean->GetValue().GetValue() ? 1 : 0);
+            return;
+        }
+        if (dynamic_cast<const None*>(node) != nullptr) {
+            WriteTag(NodeTag::NoneValue);
+            return;
+        }
+        if (const auto* variable = dynamic_cast<const VariableValue*>(node)) {
+            WriteTag(NodeTag::Variable);
+            WriteSymbols(variable->GetDottedIds());
+            return;
+        }
+        if (const auto* assignment = dynamic_cast<const Assignment*>(node)) {
+            WriteTag(NodeTag::Assign);
+            WriteString(os_, assignment->GetVar().GetName());
+            SaveNode(&assignment->GetRightValue());
+            return;
+        }
+        if (const auto* field_assignment = dynamic_cast<const FieldAssignment*>(node)) {
+            WriteTag(NodeTag::FieldAssign);
+            WriteSymbols(field_assignment->GetObject().GetDottedIds());
+            WriteString(os_, field_assignment->GetFieldName().GetName());
+            SaveNode(&field_assignment->GetRightValue());
+            return;
+        }
+        if (const auto* print = dynamic_cast<const Print*>(node)) {
+            WriteTag(NodeTag::PrintStatement);
+            SaveNodes(print->GetArgs());
+            return;
+        }
+        if (const auto* call = dynamic_cast<const MethodCall*>(node)) {
+            WriteTag(NodeTag::Call);
+            SaveNode(call->GetObject());
+            WriteString(os_, call->GetMethod().GetName());
+            SaveNodes(call->GetArgs());
+            return;
+        }
+        if (const auto* new_instance = dynamic_cast<const NewInstance*>(node)) {
+            WriteTag(NodeTag::New);
+            WriteU32(os_, ClassId(&new_instance->GetClass()));
+            SaveNodes(new_instance->GetArgs());
+            return;
+        }
+        if (const auto* stringify = dynamic_cast<const Stringify*>(node)) {
+            WriteTag(NodeTag::Str);
+            SaveNode(stringify->GetArgument());
+            return;
+        }
+        if (const auto* logical_not = dynamic_cast<const Not*>(node)) {
+            WriteTag(NodeTag::LogicalNot);
+            SaveNode(logical_not->GetArgument());
+            return;
+        }
+        if (const auto* comparison = dynamic_cast<const Comparison*>(node)) {
+            WriteTag(NodeTag::Compare);
+            WriteU8(os_, ComparatorTag(comparison->GetComparator()));
+            SaveNode(comparison->GetLhs());
+            SaveNode(comparison->GetRhs());
+            return;
+        }
+        if (SaveBinary<Add>(node, NodeTag::AddOp) || SaveBinary<Sub>(node, NodeTag::SubOp)
+            || SaveBinary<Mult>(node, NodeTag::MultOp) || SaveBinary<Div>(node, NodeTag::DivOp)
+            || SaveBinary<Or>(node, NodeTag::OrOp) || SaveBinary<And>(node, NodeTag::AndOp)) {
+            return;
+        }
+        if (const auto* compound = dynamic_cast<const Compound*>(node)) {
+            WriteTag(NodeTag::CompoundBlock);
+            SaveNodes(compound->GetStatements());
+            return;
+        }
+        if (const auto* method_body = dynamic_cast<const MethodBody*>(node)) {
+            WriteTag(NodeTag::Body);
+            SaveNode(&method_body->GetBody());
+            return;
+        }
+        if (const auto* return_stmt = dynamic_cast<const Return*>(node)) {
+            WriteTag(NodeTag::ReturnStatement);
+            SaveNode(&return_stmt->GetStatement());
+            return;
+        }
+        if (const auto* class_definition = dynamic_cast<const ClassDefinition*>(node)) {
+            SaveClassDefinition(*class_definition);
+            return;
+        }
+        if (const auto* if_else = dynamic_cast<const IfElse*>(node)) {
+            WriteTag(NodeTag::IfStatement);
+            SaveNode(&if_else->GetCondition());
+            SaveNode(&if_else->GetIfBody());
+            SaveNode(if_else->GetElseBody());
+            return;
+        }
+        if (const auto* loop = dynamic_cast<const While*>(node)) {
+            WriteTag(NodeTag::WhileStatement);
+            SaveNode(&loop->GetCondition());
+            SaveNode(&loop->GetBody());
+            return;
+        }
+        if (const auto* field_add = dynamic_cast<const FieldAddAssign*>(node)) {
+            WriteTag(NodeTag::FieldAddAssignStatement);
+            WriteSymbols(field_add->GetObject().GetDottedIds());
+            WriteString(os_, field_add->GetFieldName().GetName());
+            SaveNode(&field_add->GetRightValue());
+            return;
+        }
+        if (const auto* compare_branch = dynamic_cast<const CompareBranch*>(node)) {
+            WriteTag(NodeTag::CompareBranchStatement);
+            WriteU8(os_, ComparatorTag(compare_branch->GetComparator()));
+            SaveNode(compare_branch->GetLhs());
+            SaveNode(compare_branch->GetRhs());
+            SaveNode(&compare_branch->GetIfBody());
+            SaveNode(compare_branch->GetElseBody());
+            return;
+        }
+        throw runtime_error("Cannot serialize statement of unknown type"s);
+    }
+
+private:
+    void WriteTag(NodeTag tag) {
+        WriteU8(os_, static_cast<uint8_t>(tag));
+    }
+
+    void WriteSymbols(const vector<runtime::Symbol>& symbols) {
+        WriteU32(os_, static_cast<uint32_t>(symbols.size()));
+        for (const auto& symbol : symbols) {
+            WriteString(os_, symbol.GetName());
+        }
+    }
+
+    void SaveNodes(const vector<unique_ptr<Statement>>& nodes) {
+        WriteU32(os_, static_cast<uint32_t>(nodes.size()));
+        for (const auto& node : nodes) {
+            SaveNode(node.get());
+        }
+    }
+
+    template <typename Node>
+    bool SaveBinary(const Statement* node, NodeTag tag) {
+        const auto* binary = dynamic_cast<const Node*>(node);
+        if (binary == nullptr) {
+            return false;
+        }
+        WriteTag(tag);
+        SaveNode(binary->GetLhs());
+        SaveNode(binary->GetRhs());
+        return true;
+    }
+
+    void SaveClassDefinition(const ClassDefinition& class_definition) {
+        const auto* cls = class_definition.GetClass().TryAs<runtime::Class>();
+
+        WriteTag(NodeTag::ClassDef);
+        WriteString(os_, cls->GetName());
+        // Родитель объявлен раньше наследника: его номер уже известен
+        WriteU32(os_, cls->GetParent() != nullptr ? ClassId(cls->GetParent()) + 1 : 0);
+
+        const auto& methods = cls->GetMethods();
+        WriteU32(os_, static_cast<uint32_t>(methods.size()));
+        for (const auto& method : methods) {
+            WriteString(os_, method.name);
+            WriteSymbols(method.formal_params);
+            SaveNode(method.body.get());
+        }
+
+        classes_.push_back(cls);
+    }
+
+    // Возвращает номер ранее записанного класса
+    uint32_t ClassId(const runtime::Class* cls) const {
+        for (size_t i = 0; i < classes_.size(); ++i) {
+            if (classes_[i] == cls) {
+                return static_cast<uint32_t>(i);
+            }
+        }
+        throw runtime_error("Reference to a class that is not part of the program"s);
+    }
+
+    // Возвращает тег функции сравнения
+    static uint8_t ComparatorTag(Comparison::Comparator comparator) {
+        for (size_t i = 0; i < size(COMPARATORS); ++i) {
+            if (comparator == COMPARATORS[i]) {
+                return static_cast<uint8_t>(i);
+            }
+        }
+        throw runtime_error("Cannot serialize a non-standard comparator"s);
+    }
+
+    ostream& os_;
+    vector<const runtime::Class*> classes_;
+};
+
+// Читает дерево программы, восстанавливая классы по их номерам
+class Loader {
+public:
+    explicit Loader(istream& is)
+        : is_(is) {
+    }
+
+    unique_ptr<Statement> LoadNode() {  // NOLINT
+        const auto tag = static_cast<NodeTag>(ReadU8(is_));
+        switch (tag) {
+            case NodeTag::Absent:
+                return nullptr;
+            case NodeTag::NumericConst:
+                return make_unique<ast::NumericConst>(runtime::Number{ReadI32(is_)});
+            case NodeTag::StringConst:
+                return make_unique<ast::StringConst>(runtime::String{ReadString(is_)});
+            case NodeTag::BoolConst:
+                return make_unique<ast::BoolConst>(runtime::Bool{ReadU8(is_) != 0});
+            case NodeTag::NoneValue:
+                return make_unique<None>();
+            case NodeTag::Variable:
+                return make_unique<VariableValue>(ReadStrings());
+            case NodeTag::Assign: {
+                auto name = ReadString(is_);
+                return make_unique<Assignment>(std::move(name), LoadNode());
+            }
+            case NodeTag::FieldAssign: {
+                VariableValue object{ReadStrings()};
+                auto field_name = ReadString(is_);
+                return make_unique<FieldAssignment>(std::move(object), std::move(field_name),
+                                                    LoadNode());
+            }
+            case NodeTag::PrintStatement:
+                return make_unique<Print>(LoadNodes());
+            case NodeTag::Call: {
+                auto object = LoadNode();
+                auto method = ReadString(is_);
+                return make_unique<MethodCall>(std::move(object), std::move(method), LoadNodes());
+            }
+            case NodeTag::New: {
+                const runtime::Class& cls = LoadClassRef();
+                return make_unique<NewInstance>(cls, LoadNodes());
+            }
+            case NodeTag::Str:
+                return make_unique<Stringify>(LoadNode());
+            case NodeTag::LogicalNot:
+                return make_unique<Not>(LoadNode());
+            case NodeTag::AddOp:
+                return LoadBinary<Add>();
+            case NodeTag::SubOp:
+                return LoadBinary<Sub>();
+            case NodeTag::MultOp:
+                return LoadBinary<Mult>();
+            case NodeTag::DivOp:
+                return LoadBinary<Div>();
+            case NodeTag::OrOp:
+                return LoadBinary<Or>();
+            case NodeTag::AndOp:
+                return LoadBinary<And>();
+            case NodeTag::CompoundBlock: {
+                auto compound = make_unique<Compound>();
+                const uint32_t count = ReadU32(is_);
+                for (uint32_t i = 0; i < count; ++i) {
+                    compound->AddStatement(LoadNode());
+                }
+                return compound;
+            }
+            case NodeTag::Body:
+                return make_unique<MethodBody>(LoadNode());
+            case NodeTag::ReturnStatement:
+                return make_unique<Return>(LoadNode());
+            case NodeTag::ClassDef:
+                return LoadClassDefinition();
+            case NodeTag::IfStatement: {
+                auto condition = LoadNode();
+                auto if_body = LoadNode();
+                return make_unique<IfElse>(std::move(condition), std::move(if_body), LoadNode());
+            }
+            case NodeTag::WhileStatement: {
+                auto condition = LoadNode();
+                return make_unique<While>(std::move(condition), LoadNode());
+            }
+            case NodeTag::Compare: {
+                const uint8_t comparator_tag = ReadU8(is_);
+                if (comparator_tag >= size(COMPARATORS)) {
+                    throw runtime_error("Unknown comparator in serialized program"s);
+                }
+                auto lhs = LoadNode();
+                return MakeComparison(comparator_tag, std::move(lhs), LoadNode());
+            }
+            case NodeTag::FieldAddAssignStatement: {
+                VariableValue object{ReadStrings()};
+                auto field_name = ReadString(is_);
+                return make_unique<FieldAddAssign>(std::move(object), std::move(field_name),
+                                                   LoadNode());
+            }
+            case NodeTag::CompareBranchStatement: {
+                const uint8_t comparator_tag = ReadU8(is_);
+                if (comparator_tag >= size(COMPARATORS)) {
+                    throw runtime_error("Unknown comparator in serialized program"s);
+                }
+                auto lhs = LoadNode();
+                auto rhs = LoadNode();
+                auto if_body = LoadNode();
+                return make_unique<CompareBranch>(COMPARATORS[comparator_tag], std::move(lhs),
+                                                  std::move(rhs), std::move(if_body), LoadNode());
+            }
+        }
+        throw runtime_error("Unknown node tag in serialized program"s);
+    }
+
+private:
+    vector<string> ReadStrings() {
+        const uint32_t count = ReadU32(is_);
+        vector<string> values;
+        values.reserve(count);
+        for (uint32_t i = 0; i < count; ++i) {
+            values.push_back(ReadString(is_));
+        }
+        return values;
+    }
+
+    vector<unique_ptr<Statement>> LoadNodes() {
+        const uint32_t count = ReadU32(is_);
+        vector<unique_ptr<Statement>> nodes;
+        nodes.reserve(count);
+        for (uint32_t i = 0; i < count; ++i) {
+            nodes.push_back(LoadNode());
+        }
+        return nodes;
+    }
+
+    template <typename Node>
+    unique_ptr<Statement> LoadBinary() {
+        auto lhs = LoadNode();
+        return make_unique<Node>(std::move(lhs), LoadNode());
+    }
+
+    unique_ptr<Statement> LoadClassDefinition() {
+        auto name = ReadString(is_);
+
+        const uint32_t parent_id = ReadU32(is_);
+        const runtime::Class* parent = nullptr;
+        if (parent_id != 0) {
+            if (parent_id > classes_.size()) {
+                throw runtime_error("Unknown parent class in serialized program"s);
+            }
+            parent = classes_[parent_id - 1];
+        }
+
+        const uint32_t method_count = ReadU32(is_);
+        vector<runtime::Method> methods;
+        methods.reserve(method_count);
+        for (uint32_t i = 0; i < method_count; ++i) {
+            runtime::Method method;
+            method.name = ReadString(is_);
+            for (auto& param : ReadStrings()) {
+                method.formal_params.emplace_back(param);
+            }
+            method.body = LoadNode();
+            methods.push_back(std::move(method));
+        }
+
+        auto holder = runtime::ObjectHolder::Own(
+            runtime::Class{std::move(name), std::move(methods), parent});
+        classes_.push_back(holder.TryAs<runtime::Class>());
+        return make_unique<ClassDefinition>(std::move(holder));
+    }
+
+    // Создаёт специализированный узел сравнения по тегу функции сравнения
+    static unique_ptr<Statement> MakeComparison(uint8_t comparator_tag, unique_ptr<Statement> lhs,
+                                                unique_ptr<Statement> rhs) {
+        switch (comparator_tag) {
+            case 0:
+                return make_unique<SpecializedComparison<runtime::Equal>>(std::move(lhs),
+                                                                          std::move(rhs));
+            case 1:
+                return make_unique<SpecializedComparison<runtime::NotEqual>>(std::move(lhs),
+                                                                             std::move(rhs));
+            case 2:
+                return make_unique<SpecializedComparison<runtime::Less>>(std::move(lhs),
+                                                                         std::move(rhs));
+            case 3:
+                return make_unique<SpecializedComparison<runtime::Greater>>(std::move(lhs),
+                                                                            std::move(rhs));
+            case 4:
+                return make_unique<SpecializedComparison<runtime::LessOrEqual>>(std::move(lhs),
+                                                                                std::move(rhs));
+            default:
+                return make_unique<SpecializedComparison<runtime::GreaterOrEqual>>(std::move(lhs),
+                                                                                   std::move(rhs));
+        }
+    }
+
+    const runtime::Class& LoadClassRef() {
+        const uint32_t class_id = ReadU32(is_);
+        if (class_id >= classes_.size()) {
+            throw runtime_error("Unknown class in serialized program"s);
+        }
+        return *classes_[class_id];
+    }
+
+    istream& is_;
+    vector<runtime::Class*> classes_;
+};
+
+}  // namespace
+
+void SaveProgram(const Statement& program, ostream& os) {
+    WriteU32(os, FORMAT_MAGIC);
+    WriteU32(os, FORMAT_VERSION);
+    Saver saver{os};
+    saver.SaveNode(&program);
+}
+
+unique_ptr<Statement> LoadProgram(istream& is) {
+    if (ReadU32(is) != FORMAT_MAGIC) {
+        throw runtime_error("Not a serialized Mython program"s);
+    }
+    if (ReadU32(is) != FORMAT_VERSION) {
+        throw runtime_error("Unsupported version of a serialized Mython program"s);
+    }
+    Loader loader{is};
+    return loader.LoadNode();
+}
+
+}  // namespace ast
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "statement.h"
+
+#include <iosfwd>
+#include <memory>
+
+namespace ast {
+
+/*
+ * Двоичный формат сохранения разобранной программы.
+ *
+ * Дерево программы, построенное ParseProgram (и, как правило, упрощённое
+ * проходом Optimize), записывается один раз при деплое и загружается
+ * при старте без лексера и парсера - для коротких программ это убирает
+ * основную часть времени холодного старта. Формат включает объявления
+ * классов вместе с таблицами методов и их телами.
+ *
+ * Формат привязан к текущей версии интерпретатора: при несовпадении
+ * сигнатуры или версии загрузка завершается исключением runtime_error
+ */
+
+// Записывает дерево программы в os
+void SaveProgram(const Statement& program, std::ostream& os);
+
+// Загружает дерево программы, записанное SaveProgram.
+// При повреждённых или несовместимых данных выбрасывает runtime_error
+std::unique_ptr<Statement> LoadProgram(std::istream& is);
+
+}  // namespace ast
@@ -0,0 +1,95 @@
+#include "serialize.h"
+
+#include "lexer.h"
+#include "optimize.h"
+#include "parse.h"
+#include "test_runner_p.h"
+#include "vm.h"
+
+using namespace std;
+
+namespace ast {
+
+namespace {
+
+// Выполняет дерево программы и возвращает её вывод
+string Execute(Statement& program) {
+    runtime::DummyContext context;
+    runtime::Closure closure;
+    program.Execute(closure, context);
+    return context.output.str();
+}
+
+// Проверяет, что программа ведёт себя одинаково до записи и после загрузки
+void CheckRoundTrip(const string& source) {
+    istringstream is(source);
+    parse::Lexer lexer(is);
+    auto program = Optimize(ParseProgram(lexer));
+
+    stringstream buffer;
+    SaveProgram(*program, buffer);
+    const string expected = Execute(*program);
+
+    auto loaded = LoadProgram(buffer);
+    ASSERT_EQUAL(Execute(*loaded), expected);
+
+    // Загруженное дерево транслируется в байт-код так же, как построенное парсером
+    buffer.seekg(0);
+    auto compiled = vm::Compile(LoadProgram(buffer));
+    runtime::DummyContext context;
+    runtime::Closure closure;
+    compiled->Execute(closure, context);
+    ASSERT_EQUAL(context.output.str(), expected);
+}
+
+}  // namespace
+
+void TestSerializeSimpleProgram() {
+    CheckRoundTrip(R"(
+x = 4
+y = x + 38
+if y > 40:
+  print 'y =', y
+else:
+  print 'small'
+print not (x < y), str(x) + '!'
+)"s);
+}
+
+void TestSerializeClasses() {
+    CheckRoundTrip(R"(
+class Shape:
+  def __init__(name):
+    self.name = name
+
+  def describe():
+    return 'shape ' + self.name
+
+class Circle(Shape):
+  def describe():
+    return 'circle ' + self.name
+
+s = Shape('box')
+c = Circle('round')
+print s.describe()
+print c.describe()
+)"s);
+}
+
+void TestLoadRejectsForeignData() {
+    istringstream garbage{"not a mython image"s};
+    try {
+        LoadProgram(garbage);
+        ASSERT(false);
+    } catch (const runtime_error&) {
+        // загрузка чужих данных завершается исключением
+    }
+}
+
+void RunSerializeTests(TestRunner& tr) {
+    RUN_TEST(tr, ast::TestSerializeSimpleProgram);
+    RUN_TEST(tr, ast::TestSerializeClasses);
+    RUN_TEST(tr, ast::TestLoadRejectsForeignData);
+}
+
+}  // namespace ast
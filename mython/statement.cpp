@@ -12,8 +12,8 @@ using runtime::Context;
 using runtime::ObjectHolder;
 
 namespace {
-const string ADD_METHOD = "__add__"s;
-const string INIT_METHOD = "__init__"s;
+const runtime::Symbol ADD_METHOD{"__add__"s};
+const runtime::Symbol INIT_METHOD{"__init__"s};
 }  // namespace
 
 ObjectHolder Assignment::Execute(Closure& closure, Context& context) {
@@ -21,14 +21,18 @@ ObjectHolder Assignment::Execute(Closure& closure, Context& context) {
     return closure.at(var_);
 }
 
-Assignment::Assignment(std::string var, std::unique_ptr<Statement> rv): var_(std::move(var)), rv_(std::move(rv)) {
+Assignment::Assignment(std::string var, std::unique_ptr<Statement> rv): var_(var), rv_(std::move(rv)) {
 }
 
 VariableValue::VariableValue(const std::string& var_name) {
-    dotted_ids_.push_back(var_name);
+    dotted_ids_.emplace_back(var_name);
 }
 
-VariableValue::VariableValue(std::vector<std::string> dotted_ids): dotted_ids_(std::move(dotted_ids)) {
+VariableValue::VariableValue(std::vector<std::string> dotted_ids) {
+    dotted_ids_.reserve(dotted_ids.size());
+    for (const auto& id : dotted_ids) {
+        dotted_ids_.emplace_back(id);
+    }
 }
 
 ObjectHolder VariableValue::Execute(Closure& closure, [[maybe_unused]] Context& context) {
@@ -70,14 +74,9 @@ ObjectHolder Print::Execute(Closure& closure, Context& context) {
         if (arg != args_.front()) {
             context.GetOutputStream() << " "s;
         }
-        
+
         result = arg->Execute(closure, context);
-        
-        if (result) {
-            result->Print(context.GetOutputStream(), context);
-        } else {
-            context.GetOutputStream() << "None"s;
-        }
+        runtime::PrintValue(result, context);
     }
     context.GetOutputStream() << std::endl;
     return result;
@@ -85,7 +84,7 @@ ObjectHolder Print::Execute(Closure& closure, Context& context) {
 
 MethodCall::MethodCall(std::unique_ptr<Statement> object, std::string method,
                        std::vector<std::unique_ptr<Statement>> args): object_(std::move(object)),
-                                                                      method_(std::move(method)),
+                                                                      method_(method),
                                                                       args_(std::move(args)) {
 }
 
@@ -95,54 +94,108 @@ ObjectHolder MethodCall::Execute(Closure& closure, Context& context) {
     }
     auto obj = object_->Execute(closure, context);
     auto obj_ptr = obj.TryAs<runtime::ClassInstance>();
-    std::vector<runtime::ObjectHolder> args_values;
+    runtime::CallFrame frame;
+    auto& args_values = frame.GetArgs();
+    args_values.reserve(args_.size());
 
     for (const auto& arg : args_) {
         args_values.push_back(std::move(arg->Execute(closure, context)));
     }
-    
-    auto result = obj_ptr->Call(method_, args_values, context);
-    return result;
+
+    const auto* cls = &obj_ptr->GetClass();
+    const auto* method = call_cache_.Lookup(cls);
+    if (method == nullptr) {
+        method = cls->GetMethod(method_);
+        if (method == nullptr || method->formal_params.size() != args_values.size()) {
+            throw std::runtime_error("Not implemented"s);
+        }
+        call_cache_.Insert(cls, method);
+    }
+    return obj_ptr->CallMethod(method, args_values.data(), args_values.size(), context);
 }
 
 ObjectHolder Stringify::Execute(Closure& closure, Context& context) {
-    auto obj = argument_->Execute(closure, context);
-    if (!obj) {
-        return ObjectHolder::Own(runtime::String{ "None"s });
-    }
-    runtime::DummyContext dummy_context;
-    obj->Print(dummy_context.GetOutputStream(), dummy_context);
-    return ObjectHolder::Own(runtime::String{ dummy_context.output.str() });
+    return runtime::ToString(argument_->Execute(closure, context), context);
 }
 
 ObjectHolder Add::Execute(Closure& closure, Context& context) {
     if (!rhs_ || !lhs_) {
         throw std::runtime_error("null operands are not supported"s);
     }
-    
+
     auto lhs_res = lhs_->Execute(closure, context);
     auto rhs_res = rhs_->Execute(closure, context);
 
-    auto lhs_num = lhs_res.TryAs<runtime::Number>();
-    auto rhs_num = rhs_res.TryAs<runtime::Number>();
-    
+    // Быстрый путь по наблюдавшимся типам операндов: проверяется только
+    // запомненная категория. Несовпадение деспециализирует узел
+    switch (static_cast<OperandKind>(observed_kind_.load(std::memory_order_relaxed))) {
+        case OperandKind::Numbers: {
+            const auto* lhs_num = lhs_res.TryAs<runtime::Number>();
+            const auto* rhs_num = rhs_res.TryAs<runtime::Number>();
+            if (lhs_num != nullptr && rhs_num != nullptr) {
+                return ObjectHolder::Own(
+                    runtime::Number{lhs_num->GetValue() + rhs_num->GetValue()});
+            }
+            break;
+        }
+        case OperandKind::Strings: {
+            const auto* rhs_str = rhs_res.TryAs<runtime::String>();
+            if (rhs_str != nullptr && lhs_res.TryAs<runtime::String>() != nullptr) {
+                return runtime::String::Concat(std::move(lhs_res), *rhs_str);
+            }
+            break;
+        }
+        case OperandKind::Instance: {
+            auto* lhs_inst = lhs_res.TryAs<runtime::ClassInstance>();
+            if (lhs_inst != nullptr && lhs_inst->HasMethod(ADD_METHOD, 1)) {
+                return lhs_inst->Call(ADD_METHOD, { rhs_res }, context);
+            }
+            break;
+        }
+        case OperandKind::Unknown:
+            break;
+    }
+
+    // Общий путь: типы разбираются заново и запоминаются
+    observed_kind_.store(static_cast<std::uint8_t>(ClassifyOperands(lhs_res, rhs_res)),
+                         std::memory_order_relaxed);
+    return Evaluate(std::move(lhs_res), rhs_res, context);
+}
+
+Add::OperandKind Add::ClassifyOperands(const ObjectHolder& lhs, const ObjectHolder& rhs) {
+    if (lhs.TryAs<runtime::Number>() != nullptr && rhs.TryAs<runtime::Number>() != nullptr) {
+        return OperandKind::Numbers;
+    }
+    if (lhs.TryAs<runtime::String>() != nullptr && rhs.TryAs<runtime::String>() != nullptr) {
+        return OperandKind::Strings;
+    }
+    if (lhs.TryAs<runtime::ClassInstance>() != nullptr) {
+        return OperandKind::Instance;
+    }
+    return OperandKind::Unknown;
+}
+
+ObjectHolder Add::Evaluate(ObjectHolder lhs, const ObjectHolder& rhs, Context& context) {
+    auto lhs_num = lhs.TryAs<runtime::Number>();
+    auto rhs_num = rhs.TryAs<runtime::Number>();
+
     if (lhs_num && rhs_num) {
         return ObjectHolder::Own(runtime::Number{lhs_num->GetValue() + rhs_num->GetValue()});
     }
-    
-    auto lhs_str = lhs_res.TryAs<runtime::String>();
-    auto rhs_str = rhs_res.TryAs<runtime::String>();
+
+    auto lhs_str = lhs.TryAs<runtime::String>();
+    auto rhs_str = rhs.TryAs<runtime::String>();
     if (lhs_str && rhs_str) {
-        return ObjectHolder::Own(runtime::String{lhs_str->GetValue() + rhs_str->GetValue()});
+        return runtime::String::Concat(std::move(lhs), *rhs_str);
     }
 
-    auto lhs_class_inst = lhs_res.TryAs<runtime::ClassInstance>();
+    auto lhs_class_inst = lhs.TryAs<runtime::ClassInstance>();
 
     if (lhs_class_inst != nullptr) {
         const int ADD_METHOD_ARGS_COUNT = 1;
 
         if (lhs_class_inst->HasMethod(ADD_METHOD, ADD_METHOD_ARGS_COUNT)) {
-            return lhs_class_inst->Call(ADD_METHOD, { rhs_res }, context);
+            return lhs_class_inst->Call(ADD_METHOD, { rhs }, context);
         }
     }
 
@@ -222,13 +275,15 @@ ClassDefinition::ClassDefinition(ObjectHolder cls): cls_(std::move(cls)) {
 
 ObjectHolder ClassDefinition::Execute(Closure& closure, [[maybe_unused]] Context& context) {
     auto obj = cls_.TryAs<runtime::Class>();
-    closure[obj->GetName()] = std::move(cls_);
+    // Класс копируется, а не перемещается: объявление может выполняться
+    // повторно, когда один разобранный образ программы запускается много раз
+    closure[obj->GetName()] = cls_;
     return runtime::ObjectHolder::None();
 }
 
 FieldAssignment::FieldAssignment(VariableValue object, std::string field_name,
                                  std::unique_ptr<Statement> rv): object_(std::move(object)),
-                                                                 field_name_(std::move(field_name)),
+                                                                 field_name_(field_name),
                                                                  rv_(std::move(rv)) {
 }
 
@@ -239,6 +294,31 @@ ObjectHolder FieldAssignment::Execute(Closure& closure, Context& context) {
     return obj_ptr->Fields().at(field_name_);
 }
 
+FieldAddAssign::FieldAddAssign(VariableValue object, runtime::Symbol field_name,
+                               std::unique_ptr<Statement> rhs)
+    : object_(std::move(object))
+    , field_name_(field_name)
+    , rhs_(std::move(rhs)) {
+}
+
+ObjectHolder FieldAddAssign::Execute(Closure& closure, Context& context) {
+    auto obj = object_.Execute(closure, context);
+    auto obj_ptr = obj.TryAs<runtime::ClassInstance>();
+
+    auto field_it = obj_ptr->Fields().find(field_name_);
+    if (field_it == obj_ptr->Fields().end()) {
+        // Поле ещё не создано - та же ошибка, что при чтении через VariableValue
+        throw std::runtime_error("Invalid argument name"s);
+    }
+    // Текущее значение копируется до вычисления rhs: rhs может изменить
+    // таблицу полей и сделать слот недействительным
+    ObjectHolder current = field_it->second;
+    auto rhs_res = rhs_->Execute(closure, context);
+
+    obj_ptr->Fields()[field_name_] = Add::Evaluate(std::move(current), rhs_res, context);
+    return obj_ptr->Fields().at(field_name_);
+}
+
 IfElse::IfElse(std::unique_ptr<Statement> condition, std::unique_ptr<Statement> if_body,
                std::unique_ptr<Statement> else_body): condition_(std::move(condition)),
                                                       if_body_(std::move(if_body)),
@@ -257,6 +337,41 @@ ObjectHolder IfElse::Execute(Closure& closure, Context& context) {
     return runtime::ObjectHolder::None();
 }
 
+CompareBranch::CompareBranch(Comparison::Comparator cmp, std::unique_ptr<Statement> lhs,
+                             std::unique_ptr<Statement> rhs, std::unique_ptr<Statement> if_body,
+                             std::unique_ptr<Statement> else_body)
+    : cmp_(cmp)
+    , lhs_(std::move(lhs))
+    , rhs_(std::move(rhs))
+    , if_body_(std::move(if_body))
+    , else_body_(std::move(else_body)) {
+}
+
+ObjectHolder CompareBranch::Execute(Closure& closure, Context& context) {
+    auto lhs_res = lhs_->Execute(closure, context);
+    auto rhs_res = rhs_->Execute(closure, context);
+
+    if (cmp_(lhs_res, rhs_res, context)) {
+        return if_body_->Execute(closure, context);
+    }
+    if (else_body_) {
+        return else_body_->Execute(closure, context);
+    }
+    return runtime::ObjectHolder::None();
+}
+
+While::While(std::unique_ptr<Statement> condition, std::unique_ptr<Statement> body)
+    : condition_(std::move(condition))
+    , body_(std::move(body)) {
+}
+
+ObjectHolder While::Execute(Closure& closure, Context& context) {
+    while (runtime::IsTrue(condition_->Execute(closure, context))) {
+        body_->Execute(closure, context);
+    }
+    return runtime::ObjectHolder::None();
+}
+
 ObjectHolder Or::Execute(Closure& closure, Context& context) {
     if (!rhs_ || !lhs_) {
         throw std::runtime_error("null operands are not supported"s);
@@ -317,22 +432,27 @@ ObjectHolder Comparison::Execute(Closure& closure, Context& context) {
     return ObjectHolder::Own(runtime::Bool{ res });
 }
 
-NewInstance::NewInstance(const runtime::Class& class_, std::vector<std::unique_ptr<Statement>> args): class_inst_(class_), args_(std::move(args)) {
+NewInstance::NewInstance(const runtime::Class& class_, std::vector<std::unique_ptr<Statement>> args): cls_(class_), args_(std::move(args)) {
 }
 
-NewInstance::NewInstance(const runtime::Class& class_): class_inst_(class_) {
+NewInstance::NewInstance(const runtime::Class& class_): cls_(class_) {
 }
 
 ObjectHolder NewInstance::Execute(Closure& closure, Context& context) {
-    std::vector<runtime::ObjectHolder> args_values;
+    auto instance = runtime::ObjectHolder::Own(runtime::ClassInstance{cls_});
+    auto* instance_ptr = instance.TryAs<runtime::ClassInstance>();
+
+    runtime::CallFrame frame;
+    auto& args_values = frame.GetArgs();
+    args_values.reserve(args_.size());
     for (const auto& arg : args_) {
         args_values.push_back(std::move(arg->Execute(closure, context)));
     }
-    if (class_inst_.HasMethod(INIT_METHOD, args_.size())) {
-        class_inst_.Call(INIT_METHOD, std::move(args_values), context);
+    if (instance_ptr->HasMethod(INIT_METHOD, args_.size())) {
+        instance_ptr->Call(INIT_METHOD, args_values.data(), args_values.size(), context);
     }
-    
-    return runtime::ObjectHolder::Share(class_inst_);
+
+    return instance;
 }
 
 MethodBody::MethodBody(std::unique_ptr<Statement>&& body): body_(std::move(body)) {
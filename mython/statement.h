@@ -2,6 +2,8 @@
 
 #include "runtime.h"
 
+#include <atomic>
+#include <cstdint>
 #include <functional>
 
 namespace ast {
@@ -22,6 +24,11 @@ public:
         return runtime::ObjectHolder::Share(value_);
     }
 
+    // Возвращает хранимое значение-константу
+    [[nodiscard]] const T& GetValue() const {
+        return value_;
+    }
+
 private:
     T value_;
 };
@@ -41,9 +48,14 @@ public:
     explicit VariableValue(std::vector<std::string> dotted_ids);
 
     runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
-    
+
+    // Возвращает цепочку имён id1.id2.id3
+    [[nodiscard]] const std::vector<runtime::Symbol>& GetDottedIds() const {
+        return dotted_ids_;
+    }
+
 private:
-    std::vector<std::string> dotted_ids_;
+    std::vector<runtime::Symbol> dotted_ids_;
 };
 
 // Присваивает переменной, имя которой задано в параметре var, значение выражения rv
@@ -52,8 +64,23 @@ public:
     Assignment(std::string var, std::unique_ptr<Statement> rv);
 
     runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+
+    // Возвращает имя переменной, которой присваивается значение
+    [[nodiscard]] runtime::Symbol GetVar() const {
+        return var_;
+    }
+    // Возвращает выражение, вычисляющее присваиваемое значение
+    [[nodiscard]] Statement& GetRightValue() const {
+        return *rv_;
+    }
+    // Возвращает владеющий указатель на присваиваемое выражение
+    // (используется проходом оптимизации для замены поддерева)
+    std::unique_ptr<Statement>& GetRightValuePtr() {
+        return rv_;
+    }
+
 private:
-    std::string var_; 
+    runtime::Symbol var_;
     std::unique_ptr<Statement> rv_;
 };
 
@@ -63,11 +90,66 @@ public:
     FieldAssignment(VariableValue object, std::string field_name, std::unique_ptr<Statement> rv);
 
     runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
-    
+
+    // Возвращает выражение, вычисляющее объект, полю которого присваивается значение
+    [[nodiscard]] const VariableValue& GetObject() const {
+        return object_;
+    }
+    // Возвращает имя поля
+    [[nodiscard]] runtime::Symbol GetFieldName() const {
+        return field_name_;
+    }
+    // Возвращает выражение, вычисляющее присваиваемое значение
+    [[nodiscard]] Statement& GetRightValue() const {
+        return *rv_;
+    }
+    // Возвращает владеющий указатель на присваиваемое выражение
+    // (используется проходом оптимизации для замены поддерева)
+    std::unique_ptr<Statement>& GetRightValuePtr() {
+        return rv_;
+    }
+
 private:
-    VariableValue object_; 
-    std::string field_name_; 
-    std::unique_ptr<Statement> rv_;   
+    VariableValue object_;
+    runtime::Symbol field_name_;
+    std::unique_ptr<Statement> rv_;
+};
+
+/*
+ * Суперинструкция obj.field = obj.field + rhs. Распознаётся проходом
+ * оптимизации: вместо цепочки из пяти узлов (FieldAssignment, Add,
+ * двух VariableValue и rhs) выполняется один - объект разыменовывается
+ * единожды, поле читается и записывается на месте
+ */
+class FieldAddAssign : public Statement {
+public:
+    FieldAddAssign(VariableValue object, runtime::Symbol field_name,
+                   std::unique_ptr<Statement> rhs);
+
+    runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+
+    // Возвращает выражение, вычисляющее объект, поле которого изменяется
+    [[nodiscard]] const VariableValue& GetObject() const {
+        return object_;
+    }
+    // Возвращает имя поля
+    [[nodiscard]] runtime::Symbol GetFieldName() const {
+        return field_name_;
+    }
+    // Возвращает выражение, вычисляющее прибавляемое значение
+    [[nodiscard]] Statement& GetRightValue() const {
+        return *rhs_;
+    }
+    // Возвращает владеющий указатель на прибавляемое выражение
+    // (используется проходом оптимизации для замены поддерева)
+    std::unique_ptr<Statement>& GetRightValuePtr() {
+        return rhs_;
+    }
+
+private:
+    VariableValue object_;
+    runtime::Symbol field_name_;
+    std::unique_ptr<Statement> rhs_;
 };
 
 // Значение None
@@ -93,8 +175,18 @@ public:
     // Во время выполнения команды print вывод должен осуществляться в поток, возвращаемый из
     // context.GetOutputStream()
     runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+
+    // Возвращает список выражений-аргументов команды print
+    [[nodiscard]] const std::vector<std::unique_ptr<Statement>>& GetArgs() const {
+        return args_;
+    }
+    // Возвращает изменяемый список аргументов (для прохода оптимизации)
+    std::vector<std::unique_ptr<Statement>>& GetArgs() {
+        return args_;
+    }
+
 private:
-    std::vector<std::unique_ptr<Statement>> args_;   
+    std::vector<std::unique_ptr<Statement>> args_;
 };
 
 
@@ -105,10 +197,36 @@ public:
                std::vector<std::unique_ptr<Statement>> args);
 
     runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+
+    // Возвращает выражение, вычисляющее объект, метод которого вызывается,
+    // либо nullptr, если объект не задан
+    [[nodiscard]] Statement* GetObject() const {
+        return object_.get();
+    }
+    // Возвращает имя вызываемого метода
+    [[nodiscard]] runtime::Symbol GetMethod() const {
+        return method_;
+    }
+    // Возвращает список выражений-аргументов вызова
+    [[nodiscard]] const std::vector<std::unique_ptr<Statement>>& GetArgs() const {
+        return args_;
+    }
+    // Возвращает изменяемый список аргументов (для прохода оптимизации)
+    std::vector<std::unique_ptr<Statement>>& GetArgs() {
+        return args_;
+    }
+    // Возвращает владеющий указатель на выражение-объект (для прохода оптимизации)
+    std::unique_ptr<Statement>& GetObjectPtr() {
+        return object_;
+    }
+
 private:
-    std::unique_ptr<Statement> object_; 
-    std::string method_;
+    std::unique_ptr<Statement> object_;
+    runtime::Symbol method_;
     std::vector<std::unique_ptr<Statement>> args_;
+    // Инлайн-кэш разрешённых методов. Безопасен при одновременном
+    // выполнении узла из нескольких потоков
+    runtime::MethodCache call_cache_;
 };
 
 /*
@@ -130,8 +248,19 @@ public:
     NewInstance(const runtime::Class& class_, std::vector<std::unique_ptr<Statement>> args);
     // Возвращает объект, содержащий значение типа ClassInstance
     runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+
+    // Возвращает класс создаваемого экземпляра
+    [[nodiscard]] const runtime::Class& GetClass() const {
+        return cls_;
+    }
+    // Возвращает список выражений-аргументов конструктора
+    [[nodiscard]] const std::vector<std::unique_ptr<Statement>>& GetArgs() const {
+        return args_;
+    }
 private:
-    runtime::ClassInstance class_inst_;
+    // Узел не хранит сам экземпляр: каждое выполнение создаёт новый,
+    // поэтому узел можно выполнять повторно и из нескольких потоков
+    const runtime::Class& cls_;
 	std::vector<std::unique_ptr<Statement>> args_;
 };
 
@@ -140,6 +269,16 @@ class UnaryOperation : public Statement {
 public:
     explicit UnaryOperation(std::unique_ptr<Statement> argument): argument_(std::move(argument)) {
     }
+
+    // Возвращает аргумент операции либо nullptr
+    [[nodiscard]] Statement* GetArgument() const {
+        return argument_.get();
+    }
+    // Возвращает владеющий указатель на аргумент (для прохода оптимизации)
+    std::unique_ptr<Statement>& GetArgumentPtr() {
+        return argument_;
+    }
+
 protected:
     std::unique_ptr<Statement> argument_;
 };
@@ -156,6 +295,24 @@ class BinaryOperation : public Statement {
 public:
     BinaryOperation(std::unique_ptr<Statement> lhs, std::unique_ptr<Statement> rhs): lhs_(std::move(lhs)), rhs_(std::move(rhs)) {
     }
+
+    // Возвращает левый аргумент операции либо nullptr
+    [[nodiscard]] Statement* GetLhs() const {
+        return lhs_.get();
+    }
+    // Возвращает правый аргумент операции либо nullptr
+    [[nodiscard]] Statement* GetRhs() const {
+        return rhs_.get();
+    }
+    // Возвращает владеющий указатель на левый аргумент (для прохода оптимизации)
+    std::unique_ptr<Statement>& GetLhsPtr() {
+        return lhs_;
+    }
+    // Возвращает владеющий указатель на правый аргумент (для прохода оптимизации)
+    std::unique_ptr<Statement>& GetRhsPtr() {
+        return rhs_;
+    }
+
 protected:
     std::unique_ptr<Statement> lhs_;
     std::unique_ptr<Statement> rhs_;
@@ -172,6 +329,31 @@ public:
     //  объект1 + объект2, если у объект1 - пользовательский класс с методом _add__(rhs)
     // В противном случае при вычислении выбрасывается runtime_error
     runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+
+    // Складывает уже вычисленные значения lhs и rhs по правилам операции +.
+    // Используется также суперинструкцией FieldAddAssign
+    static runtime::ObjectHolder Evaluate(runtime::ObjectHolder lhs,
+                                          const runtime::ObjectHolder& rhs,
+                                          runtime::Context& context);
+
+private:
+    // Категория типов операндов, наблюдавшаяся в этом узле
+    enum class OperandKind : std::uint8_t {
+        Unknown = 0,  // типы ещё не наблюдались либо не поддерживаются
+        Numbers,      // число + число
+        Strings,      // строка + строка
+        Instance,     // слева экземпляр класса с методом __add__
+    };
+
+    // Определяет категорию типов уже вычисленных операндов
+    static OperandKind ClassifyOperands(const runtime::ObjectHolder& lhs,
+                                        const runtime::ObjectHolder& rhs);
+
+    // Инлайн-кэш типов: конкретный узел + почти всегда видит операнды
+    // одних и тех же типов, поэтому Execute идёт сразу по запомненному
+    // пути, а при несовпадении типов деспециализируется в общий разбор.
+    // Кэш атомарный: узел может выполняться из нескольких потоков
+    std::atomic<std::uint8_t> observed_kind_{0};
 };
 
 // Возвращает результат вычитания аргументов lhs и rhs
@@ -250,6 +432,16 @@ public:
 
     // Последовательно выполняет добавленные инструкции. Возвращает None
     runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+
+    // Возвращает список добавленных инструкций
+    [[nodiscard]] const std::vector<std::unique_ptr<Statement>>& GetStatements() const {
+        return stmt_;
+    }
+    // Возвращает изменяемый список инструкций (для прохода оптимизации)
+    std::vector<std::unique_ptr<Statement>>& GetStatements() {
+        return stmt_;
+    }
+
 private:
     std::vector<std::unique_ptr<Statement>> stmt_;
 };
@@ -263,6 +455,16 @@ public:
     // Если внутри body была выполнена инструкция return, возвращает результат return
     // В противном случае возвращает None
     runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+
+    // Возвращает тело метода
+    [[nodiscard]] Statement& GetBody() const {
+        return *body_;
+    }
+    // Возвращает владеющий указатель на тело метода (для прохода оптимизации)
+    std::unique_ptr<Statement>& GetBodyPtr() {
+        return body_;
+    }
+
 private:
     std::unique_ptr<Statement> body_;
 };
@@ -276,6 +478,16 @@ public:
     // Останавливает выполнение текущего метода. После выполнения инструкции return метод,
     // внутри которого она была исполнена, должен вернуть результат вычисления выражения statement.
     runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+
+    // Возвращает выражение, результат которого возвращает инструкция return
+    [[nodiscard]] Statement& GetStatement() const {
+        return *statement_;
+    }
+    // Возвращает владеющий указатель на выражение (для прохода оптимизации)
+    std::unique_ptr<Statement>& GetStatementPtr() {
+        return statement_;
+    }
+
 private:
     std::unique_ptr<Statement> statement_;
 };
@@ -289,6 +501,11 @@ public:
     // Создаёт внутри closure новый объект, совпадающий с именем класса и значением, переданным в
     // конструктор
     runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+
+    // Возвращает объявляемый класс
+    [[nodiscard]] const runtime::ObjectHolder& GetClass() const {
+        return cls_;
+    }
 private:
     runtime::ObjectHolder cls_;
 };
@@ -301,26 +518,157 @@ public:
            std::unique_ptr<Statement> else_body);
 
     runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+
+    // Возвращает условие инструкции if
+    [[nodiscard]] Statement& GetCondition() const {
+        return *condition_;
+    }
+    // Возвращает тело ветки if
+    [[nodiscard]] Statement& GetIfBody() const {
+        return *if_body_;
+    }
+    // Возвращает тело ветки else либо nullptr, если ветка else отсутствует
+    [[nodiscard]] Statement* GetElseBody() const {
+        return else_body_.get();
+    }
+    // Возвращает владеющий указатель на условие (для прохода оптимизации)
+    std::unique_ptr<Statement>& GetConditionPtr() {
+        return condition_;
+    }
+    // Возвращает владеющий указатель на тело ветки if (для прохода оптимизации)
+    std::unique_ptr<Statement>& GetIfBodyPtr() {
+        return if_body_;
+    }
+    // Возвращает владеющий указатель на тело ветки else (для прохода оптимизации)
+    std::unique_ptr<Statement>& GetElseBodyPtr() {
+        return else_body_;
+    }
+
 private:
-    std::unique_ptr<Statement> condition_; 
+    std::unique_ptr<Statement> condition_;
     std::unique_ptr<Statement> if_body_;
     std::unique_ptr<Statement> else_body_;
 };
 
+// Цикл while condition: body. Итерации выполняются в текущем кадре,
+// без рекурсивных вызовов методов
+class While : public Statement {
+public:
+    While(std::unique_ptr<Statement> condition, std::unique_ptr<Statement> body);
+
+    runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+
+    // Возвращает условие цикла
+    [[nodiscard]] Statement& GetCondition() const {
+        return *condition_;
+    }
+    // Возвращает тело цикла
+    [[nodiscard]] Statement& GetBody() const {
+        return *body_;
+    }
+    // Возвращает владеющий указатель на условие (для прохода оптимизации)
+    std::unique_ptr<Statement>& GetConditionPtr() {
+        return condition_;
+    }
+    // Возвращает владеющий указатель на тело цикла (для прохода оптимизации)
+    std::unique_ptr<Statement>& GetBodyPtr() {
+        return body_;
+    }
+
+private:
+    std::unique_ptr<Statement> condition_;
+    std::unique_ptr<Statement> body_;
+};
+
 // Операция сравнения
 class Comparison : public BinaryOperation {
 public:
     // Comparator задаёт функцию, выполняющую сравнение значений аргументов
-    using Comparator = std::function<bool(const runtime::ObjectHolder&,
-                                          const runtime::ObjectHolder&, runtime::Context&)>;
+    using Comparator = bool (*)(const runtime::ObjectHolder&, const runtime::ObjectHolder&,
+                                runtime::Context&);
 
     Comparison(Comparator cmp, std::unique_ptr<Statement> lhs, std::unique_ptr<Statement> rhs);
 
     // Вычисляет значение выражений lhs и rhs и возвращает результат работы comparator,
     // приведённый к типу runtime::Bool
     runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+
+    // Возвращает функцию сравнения
+    [[nodiscard]] Comparator GetComparator() const {
+        return cmp_;
+    }
 private:
     Comparator cmp_;
 };
 
+// Специализация сравнения: функция сравнения известна на этапе компиляции,
+// поэтому её вызов в Execute прямой и может быть встроен компилятором
+template <Comparison::Comparator Cmp>
+class SpecializedComparison final : public Comparison {
+public:
+    SpecializedComparison(std::unique_ptr<Statement> lhs, std::unique_ptr<Statement> rhs)
+        : Comparison(Cmp, std::move(lhs), std::move(rhs)) {
+    }
+
+    runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override {
+        if (!lhs_ || !rhs_) {
+            throw std::runtime_error("null operands are not supported");
+        }
+        auto lhs_res = lhs_->Execute(closure, context);
+        auto rhs_res = rhs_->Execute(closure, context);
+        return runtime::ObjectHolder::Own(runtime::Bool{Cmp(lhs_res, rhs_res, context)});
+    }
+};
+
+/*
+ * Суперинструкция if с условием-сравнением: сравнение и ветвление
+ * выполняются одним узлом, без промежуточного значения runtime::Bool.
+ * Распознаётся проходом оптимизации из пары Comparison + IfElse
+ */
+class CompareBranch : public Statement {
+public:
+    // Параметр else_body может быть равен nullptr
+    CompareBranch(Comparison::Comparator cmp, std::unique_ptr<Statement> lhs,
+                  std::unique_ptr<Statement> rhs, std::unique_ptr<Statement> if_body,
+                  std::unique_ptr<Statement> else_body);
+
+    runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+
+    // Возвращает функцию сравнения
+    [[nodiscard]] Comparison::Comparator GetComparator() const {
+        return cmp_;
+    }
+    // Возвращает левый аргумент сравнения
+    [[nodiscard]] Statement* GetLhs() const {
+        return lhs_.get();
+    }
+    // Возвращает правый аргумент сравнения
+    [[nodiscard]] Statement* GetRhs() const {
+        return rhs_.get();
+    }
+    // Возвращает тело ветки if
+    [[nodiscard]] Statement& GetIfBody() const {
+        return *if_body_;
+    }
+    // Возвращает тело ветки else либо nullptr, если ветка else отсутствует
+    [[nodiscard]] Statement* GetElseBody() const {
+        return else_body_.get();
+    }
+    // Возвращает владеющий указатель на тело ветки if (для прохода оптимизации)
+    std::unique_ptr<Statement>& GetIfBodyPtr() {
+        return if_body_;
+    }
+    // Возвращает владеющий указатель на тело ветки else (для прохода оптимизации)
+    std::unique_ptr<Statement>& GetElseBodyPtr() {
+        return else_body_;
+    }
+
+private:
+    Comparison::Comparator cmp_;
+    std::unique_ptr<Statement> lhs_;
+    std::unique_ptr<Statement> rhs_;
+    std::unique_ptr<Statement> if_body_;
+    std::unique_ptr<Statement> else_body_;
+};
+
 }  // namespace ast
\ No newline at end of file
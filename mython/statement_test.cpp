@@ -287,6 +287,37 @@ void TestClassInstanceAddWithoutMethod() {
     ASSERT(context.output.str().empty());
 }
 
+void TestAddTypeFeedback() {
+    runtime::DummyContext context;
+
+    Closure closure;
+    closure["x"s] = runtime::ObjectHolder::Own(runtime::Number{1});
+    closure["y"s] = runtime::ObjectHolder::Own(runtime::Number{2});
+
+    Add sum(make_unique<VariableValue>("x"s), make_unique<VariableValue>("y"s));
+
+    // Числовой путь стабилен при повторных выполнениях
+    for (int i = 0; i < 3; ++i) {
+        ASSERT_OBJECT_VALUE_EQUAL(sum.Execute(closure, context), 3);
+    }
+
+    // Типы операндов сменились - узел деспециализируется на строки
+    closure.at("x"s) = runtime::ObjectHolder::Own(runtime::String{"ab"s});
+    closure.at("y"s) = runtime::ObjectHolder::Own(runtime::String{"cd"s});
+    for (int i = 0; i < 3; ++i) {
+        ASSERT_OBJECT_VALUE_EQUAL(sum.Execute(closure, context), "abcd"s);
+    }
+
+    // И обратно на числа
+    closure.at("x"s) = runtime::ObjectHolder::Own(runtime::Number{5});
+    closure.at("y"s) = runtime::ObjectHolder::Own(runtime::Number{7});
+    ASSERT_OBJECT_VALUE_EQUAL(sum.Execute(closure, context), 12);
+
+    // Неподдерживаемая пара типов по-прежнему приводит к ошибке
+    closure.at("y"s) = runtime::ObjectHolder::Own(runtime::String{"cd"s});
+    ASSERT_THROWS(sum.Execute(closure, context), std::runtime_error);
+}
+
 void TestCompound() {
     runtime::DummyContext context;
 
@@ -469,6 +500,7 @@ void RunUnitTests(TestRunner& tr) {
     RUN_TEST(tr, ast::TestBadAddition);
     RUN_TEST(tr, ast::TestSuccessfulClassInstanceAdd);
     RUN_TEST(tr, ast::TestClassInstanceAddWithoutMethod);
+    RUN_TEST(tr, ast::TestAddTypeFeedback);
     RUN_TEST(tr, ast::TestCompound);
     RUN_TEST(tr, ast::TestFields);
     RUN_TEST(tr, ast::TestBaseClass);
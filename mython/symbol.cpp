@@ -0,0 +1,58 @@
+#include "symbol.h"
+
+#include <deque>
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
+
+using namespace std;
+
+namespace runtime {
+
+namespace {
+
+// Общая таблица символов. Хранит каждое уникальное имя один раз;
+// адреса строк стабильны, поэтому Symbol может ссылаться на них напрямую
+class SymbolTable {
+public:
+    static SymbolTable& Instance() {
+        static SymbolTable table;
+        return table;
+    }
+
+    // Возвращает запись таблицы для имени name, при необходимости создавая её
+    pair<const string*, uint32_t> Intern(string_view name) {
+        lock_guard guard{mutex_};
+
+        if (auto it = ids_.find(name); it != ids_.end()) {
+            return {&names_[it->second], it->second};
+        }
+
+        const auto id = static_cast<uint32_t>(names_.size());
+        const string& stored = names_.emplace_back(name);
+        ids_.emplace(stored, id);
+        return {&stored, id};
+    }
+
+private:
+    SymbolTable() = default;
+
+    mutex mutex_;
+    // deque не перемещает элементы при росте - ссылки на имена остаются действительными
+    deque<string> names_;
+    unordered_map<string_view, uint32_t> ids_;
+};
+
+}  // namespace
+
+Symbol::Symbol(const std::string& name) {
+    auto [stored_name, id] = SymbolTable::Instance().Intern(name);
+    name_ = stored_name;
+    id_ = id;
+}
+
+Symbol::Symbol(const char* name)
+    : Symbol(std::string(name)) {
+}
+
+}  // namespace runtime
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+
+namespace runtime {
+
+/*
+ * Интернированный идентификатор (имя переменной, поля, метода или класса).
+ * Каждое уникальное имя регистрируется в общей таблице символов один раз,
+ * поэтому сравнение и хеширование символов - операции над маленьким целым,
+ * а не над содержимым строки.
+ *
+ * Symbol неявно создаётся из строки: в местах, где имя уже известно
+ * (узлы АСТ, байт-код), интернирование выполняется один раз при построении,
+ * и все последующие обращения к таблицам символов обходятся без
+ * хеширования строк
+ */
+class Symbol {
+public:
+    Symbol(const std::string& name);  // NOLINT(google-explicit-constructor,hicpp-explicit-conversions)
+    Symbol(const char* name);         // NOLINT(google-explicit-constructor,hicpp-explicit-conversions)
+
+    // Возвращает имя символа. Ссылка действительна до конца работы программы
+    [[nodiscard]] const std::string& GetName() const {
+        return *name_;
+    }
+
+    // Возвращает уникальный номер символа в таблице
+    [[nodiscard]] std::uint32_t GetId() const {
+        return id_;
+    }
+
+private:
+    const std::string* name_;
+    std::uint32_t id_;
+};
+
+inline bool operator==(Symbol lhs, Symbol rhs) {
+    return lhs.GetId() == rhs.GetId();
+}
+
+inline bool operator!=(Symbol lhs, Symbol rhs) {
+    return !(lhs == rhs);
+}
+
+}  // namespace runtime
+
+template <>
+struct std::hash<runtime::Symbol> {
+    std::size_t operator()(runtime::Symbol symbol) const noexcept {
+        return symbol.GetId();
+    }
+};
@@ -0,0 +1,523 @@
+#include "vm.h"
+
+#include "statement.h"
+
+#include <sstream>
+#include <utility>
+
+using namespace std;
+
+namespace vm {
+
+namespace {
+
+const runtime::Symbol ADD_METHOD{"__add__"s};
+
+// Транслятор дерева инструкций в байт-код. Обходит дерево и наполняет Chunk
+class Compiler {
+public:
+    Chunk Compile(runtime::Executable& root) {
+        CompileStatement(root);
+        return std::move(chunk_);
+    }
+
+private:
+    // Транслирует инструкцию: после её выполнения стек остаётся неизменным
+    void CompileStatement(runtime::Executable& node) {
+        if (auto* compound = dynamic_cast<ast::Compound*>(&node)) {
+            for (const auto& stmt : compound->GetStatements()) {
+                CompileStatement(*stmt);
+            }
+            return;
+        }
+        if (auto* assignment = dynamic_cast<ast::Assignment*>(&node)) {
+            CompileExpression(assignment->GetRightValue());
+            Emit(Op::StoreName, AddName(assignment->GetVar()));
+            return;
+        }
+        if (auto* field_assignment = dynamic_cast<ast::FieldAssignment*>(&node)) {
+            CompileVariableValue(field_assignment->GetObject());
+            CompileExpression(field_assignment->GetRightValue());
+            Emit(Op::StoreField, AddName(field_assignment->GetFieldName()));
+            return;
+        }
+        if (auto* print = dynamic_cast<ast::Print*>(&node)) {
+            bool is_first = true;
+            for (const auto& arg : print->GetArgs()) {
+                // Разделитель выводится до вычисления очередного аргумента -
+                // так же, как в ast::Print::Execute
+                if (!is_first) {
+                    Emit(Op::PrintSep);
+                }
+                is_first = false;
+                CompileExpression(*arg);
+                Emit(Op::PrintValue);
+            }
+            Emit(Op::PrintNewline);
+            return;
+        }
+        if (auto* if_else = dynamic_cast<ast::IfElse*>(&node)) {
+            CompileIfElse(*if_else);
+            return;
+        }
+        if (auto* loop = dynamic_cast<ast::While*>(&node)) {
+            CompileWhile(*loop);
+            return;
+        }
+        if (auto* ret = dynamic_cast<ast::Return*>(&node)) {
+            CompileExpression(ret->GetStatement());
+            Emit(Op::Return);
+            return;
+        }
+        // Остальные инструкции (в том числе вызов метода в роли инструкции)
+        // вычисляются как выражение, результат которого отбрасывается
+        CompileExpression(node);
+        Emit(Op::Pop);
+    }
+
+    // Транслирует выражение: после его выполнения на стеке остаётся одно значение
+    void CompileExpression(runtime::Executable& node) {
+        if (auto* numeric = dynamic_cast<ast::NumericConst*>(&node)) {
+            Emit(Op::Const, AddConstant(runtime::ObjectHolder::Own(
+                                runtime::Number{numeric->GetValue()})));
+            return;
+        }
+        if (auto* str = dynamic_cast<ast::StringConst*>(&node)) {
+            Emit(Op::Const,
+                 AddConstant(runtime::ObjectHolder::Own(runtime::String{str->GetValue()})));
+            return;
+        }
+        if (auto* boolean = dynamic_cast<ast::BoolConst*>(&node)) {
+            Emit(Op::Const,
+                 AddConstant(runtime::ObjectHolder::Own(runtime::Bool{boolean->GetValue()})));
+            return;
+        }
+        if (dynamic_cast<ast::None*>(&node) != nullptr) {
+            Emit(Op::None);
+            return;
+        }
+        if (auto* variable = dynamic_cast<ast::VariableValue*>(&node)) {
+            CompileVariableValue(*variable);
+            return;
+        }
+        if (auto* add = dynamic_cast<ast::Add*>(&node)) {
+            CompileBinary(*add, Op::Add);
+            return;
+        }
+        if (auto* sub = dynamic_cast<ast::Sub*>(&node)) {
+            CompileBinary(*sub, Op::Sub);
+            return;
+        }
+        if (auto* mult = dynamic_cast<ast::Mult*>(&node)) {
+            CompileBinary(*mult, Op::Mul);
+            return;
+        }
+        if (auto* div = dynamic_cast<ast::Div*>(&node)) {
+            CompileBinary(*div, Op::Div);
+            return;
+        }
+        if (auto* logical_or = dynamic_cast<ast::Or*>(&node)) {
+            CompileBinary(*logical_or, Op::Or);
+            return;
+        }
+        if (auto* logical_and = dynamic_cast<ast::And*>(&node)) {
+            CompileBinary(*logical_and, Op::And);
+            return;
+        }
+        if (auto* logical_not = dynamic_cast<ast::Not*>(&node)) {
+            if (logical_not->GetArgument() == nullptr) {
+                throw std::runtime_error("null operands are not supported"s);
+            }
+            CompileExpression(*logical_not->GetArgument());
+            Emit(Op::Not);
+            return;
+        }
+        if (auto* stringify = dynamic_cast<ast::Stringify*>(&node)) {
+            CompileExpression(*stringify->GetArgument());
+            Emit(Op::Str);
+            return;
+        }
+        if (auto* call = dynamic_cast<ast::MethodCall*>(&node)) {
+            if (call->GetObject() == nullptr) {
+                Emit(Op::None);
+                return;
+            }
+            CompileExpression(*call->GetObject());
+            for (const auto& arg : call->GetArgs()) {
+                CompileExpression(*arg);
+            }
+            chunk_.call_sites.push_back(CallSite{call->GetMethod(), {}});
+            Emit(Op::Call, static_cast<uint32_t>(chunk_.call_sites.size() - 1),
+                 static_cast<uint32_t>(call->GetArgs().size()));
+            return;
+        }
+        // Запасной путь: узел выполняется напрямую как runtime::Executable.
+        // Сюда попадают объявления классов, создание экземпляров и сравнения
+        chunk_.statements.push_back(&node);
+        Emit(Op::Execute, static_cast<uint32_t>(chunk_.statements.size() - 1));
+    }
+
+    void CompileVariableValue(const ast::VariableValue& variable) {
+        const auto& ids = variable.GetDottedIds();
+        if (ids.size() == 1) {
+            Emit(Op::LoadName, AddName(ids.front()));
+        } else {
+            chunk_.chains.push_back(ids);
+            Emit(Op::LoadChain, static_cast<uint32_t>(chunk_.chains.size() - 1));
+        }
+    }
+
+    void CompileBinary(const ast::BinaryOperation& operation, Op op) {
+        if (operation.GetLhs() == nullptr || operation.GetRhs() == nullptr) {
+            throw std::runtime_error("null operands are not supported"s);
+        }
+        CompileExpression(*operation.GetLhs());
+        CompileExpression(*operation.GetRhs());
+        Emit(op);
+    }
+
+    void CompileIfElse(const ast::IfElse& if_else) {
+        CompileExpression(if_else.GetCondition());
+        size_t jump_to_else = Emit(Op::JumpIfFalse);
+        CompileStatement(if_else.GetIfBody());
+        if (auto* else_body = if_else.GetElseBody()) {
+            size_t jump_to_end = Emit(Op::Jump);
+            PatchJump(jump_to_else);
+            CompileStatement(*else_body);
+            PatchJump(jump_to_end);
+        } else {
+            PatchJump(jump_to_else);
+        }
+    }
+
+    // Цикл компилируется в условный выход вперёд и безусловный переход
+    // назад к вычислению условия
+    void CompileWhile(const ast::While& loop) {
+        const size_t loop_start = chunk_.instructions.size();
+        CompileExpression(loop.GetCondition());
+        size_t jump_to_end = Emit(Op::JumpIfFalse);
+        CompileStatement(loop.GetBody());
+        Emit(Op::Jump, static_cast<uint32_t>(loop_start));
+        PatchJump(jump_to_end);
+    }
+
+    size_t Emit(Op op, uint32_t arg = 0, uint32_t arg2 = 0) {
+        chunk_.instructions.push_back({op, arg, arg2});
+        return chunk_.instructions.size() - 1;
+    }
+
+    // Направляет инструкцию перехода instruction_index на следующую инструкцию
+    void PatchJump(size_t instruction_index) {
+        chunk_.instructions[instruction_index].arg
+            = static_cast<uint32_t>(chunk_.instructions.size());
+    }
+
+    uint32_t AddConstant(runtime::ObjectHolder value) {
+        // Типичные программы используют одни и те же константы (0, 1, True)
+        // многократно - одинаковые значения хранятся в пуле в одном экземпляре
+        for (size_t i = 0; i < chunk_.constants.size(); ++i) {
+            if (SameConstant(chunk_.constants[i], value)) {
+                return static_cast<uint32_t>(i);
+            }
+        }
+        chunk_.constants.push_back(std::move(value));
+        return static_cast<uint32_t>(chunk_.constants.size() - 1);
+    }
+
+    // Возвращает true, если lhs и rhs - константы одного типа с равными значениями
+    static bool SameConstant(const runtime::ObjectHolder& lhs, const runtime::ObjectHolder& rhs) {
+        if (lhs->GetType() != rhs->GetType()) {
+            return false;
+        }
+        switch (lhs->GetType()) {
+            case runtime::Object::Type::Number:
+                return static_cast<const runtime::Number*>(lhs.Get())->GetValue()
+                       == static_cast<const runtime::Number*>(rhs.Get())->GetValue();
+            case runtime::Object::Type::String:
+                return static_cast<const runtime::String*>(lhs.Get())->GetValue()
+                       == static_cast<const runtime::String*>(rhs.Get())->GetValue();
+            case runtime::Object::Type::Bool:
+                return static_cast<const runtime::Bool*>(lhs.Get())->GetValue()
+                       == static_cast<const runtime::Bool*>(rhs.Get())->GetValue();
+            default:
+                return false;
+        }
+    }
+
+    uint32_t AddName(runtime::Symbol name) {
+        for (size_t i = 0; i < chunk_.names.size(); ++i) {
+            if (chunk_.names[i] == name) {
+                return static_cast<uint32_t>(i);
+            }
+        }
+        chunk_.names.push_back(name);
+        return static_cast<uint32_t>(chunk_.names.size() - 1);
+    }
+
+    Chunk chunk_;
+};
+
+// Вычисляет значение цепочки полей id1.id2.id3 так же, как ast::VariableValue
+runtime::ObjectHolder LoadChain(const vector<runtime::Symbol>& ids, runtime::Closure& closure) {
+    runtime::ObjectHolder result;
+    runtime::Closure* current_closure_ptr = &closure;
+    for (const auto& var_name : ids) {
+        auto var_it = current_closure_ptr->find(var_name);
+        if (var_it == current_closure_ptr->end()) {
+            throw std::runtime_error("Invalid argument name"s);
+        }
+        result = var_it->second;
+        auto next_dotted_var = result.TryAs<runtime::ClassInstance>();
+        if (next_dotted_var) {
+            current_closure_ptr = &next_dotted_var->Fields();
+        }
+    }
+    return result;
+}
+
+runtime::ObjectHolder ExecuteAdd(runtime::ObjectHolder lhs, const runtime::ObjectHolder& rhs,
+                                 runtime::Context& context) {
+    auto lhs_num = lhs.TryAs<runtime::Number>();
+    auto rhs_num = rhs.TryAs<runtime::Number>();
+    if (lhs_num && rhs_num) {
+        return runtime::ObjectHolder::Own(
+            runtime::Number{lhs_num->GetValue() + rhs_num->GetValue()});
+    }
+
+    auto lhs_str = lhs.TryAs<runtime::String>();
+    auto rhs_str = rhs.TryAs<runtime::String>();
+    if (lhs_str && rhs_str) {
+        return runtime::String::Concat(std::move(lhs), *rhs_str);
+    }
+
+    auto lhs_class_inst = lhs.TryAs<runtime::ClassInstance>();
+    if (lhs_class_inst != nullptr && lhs_class_inst->HasMethod(ADD_METHOD, 1)) {
+        return lhs_class_inst->Call(ADD_METHOD, {rhs}, context);
+    }
+
+    throw std::runtime_error("Wrong types for add operation");
+}
+
+int ExpectNumbers(const runtime::ObjectHolder& lhs, const runtime::ObjectHolder& rhs,
+                  int& rhs_value, const char* error_message) {
+    auto lhs_num = lhs.TryAs<runtime::Number>();
+    auto rhs_num = rhs.TryAs<runtime::Number>();
+    if (!lhs_num || !rhs_num) {
+        throw std::runtime_error(error_message);
+    }
+    rhs_value = rhs_num->GetValue();
+    return lhs_num->GetValue();
+}
+
+// Возвращает имя операции для счётчиков инструментирования
+const char* OpName(Op op) {
+    switch (op) {
+        case Op::Const: return "Const";
+        case Op::None: return "None";
+        case Op::LoadName: return "LoadName";
+        case Op::LoadChain: return "LoadChain";
+        case Op::StoreName: return "StoreName";
+        case Op::StoreField: return "StoreField";
+        case Op::Add: return "Add";
+        case Op::Sub: return "Sub";
+        case Op::Mul: return "Mul";
+        case Op::Div: return "Div";
+        case Op::Or: return "Or";
+        case Op::And: return "And";
+        case Op::Not: return "Not";
+        case Op::Str: return "Str";
+        case Op::PrintSep: return "PrintSep";
+        case Op::PrintValue: return "PrintValue";
+        case Op::PrintNewline: return "PrintNewline";
+        case Op::Call: return "Call";
+        case Op::Return: return "Return";
+        case Op::Jump: return "Jump";
+        case Op::JumpIfFalse: return "JumpIfFalse";
+        case Op::Pop: return "Pop";
+        case Op::Execute: return "Execute";
+    }
+    return "Unknown";
+}
+
+}  // namespace
+
+Program::Program(Chunk chunk, std::unique_ptr<runtime::Executable> source)
+    : chunk_(std::move(chunk))
+    , source_(std::move(source)) {
+}
+
+const Chunk& Program::GetChunk() const {
+    return chunk_;
+}
+
+runtime::ObjectHolder Program::Execute(runtime::Closure& closure, runtime::Context& context) {
+    vector<runtime::ObjectHolder> stack;
+    stack.reserve(16);
+
+    const auto pop = [&stack] {
+        runtime::ObjectHolder value = std::move(stack.back());
+        stack.pop_back();
+        return value;
+    };
+
+    // Указатель на счётчики стабилен на время выполнения: когда сбор
+    // выключен, остаётся лишь предсказуемая проверка на nullptr
+    runtime::InstrumentationStats* stats = runtime::CurrentInstrumentation();
+
+    const size_t instruction_count = chunk_.instructions.size();
+    for (size_t ip = 0; ip < instruction_count;) {
+        const Instruction& instruction = chunk_.instructions[ip];
+        ++ip;
+
+        if (stats != nullptr) {
+            ++stats->executed_ops[OpName(instruction.op)];
+        }
+
+        switch (instruction.op) {
+            case Op::Const:
+                stack.push_back(chunk_.constants[instruction.arg]);
+                break;
+            case Op::None:
+                stack.push_back(runtime::ObjectHolder::None());
+                break;
+            case Op::LoadName: {
+                auto var_it = closure.find(chunk_.names[instruction.arg]);
+                if (var_it == closure.end()) {
+                    throw std::runtime_error("Invalid argument name"s);
+                }
+                stack.push_back(var_it->second);
+                break;
+            }
+            case Op::LoadChain:
+                stack.push_back(LoadChain(chunk_.chains[instruction.arg], closure));
+                break;
+            case Op::StoreName:
+                closure[chunk_.names[instruction.arg]] = pop();
+                break;
+            case Op::StoreField: {
+                auto value = pop();
+                auto object = pop();
+                auto* instance = object.TryAs<runtime::ClassInstance>();
+                if (instance == nullptr) {
+                    throw std::runtime_error("Cannot assign a field of a non-object value"s);
+                }
+                instance->Fields()[chunk_.names[instruction.arg]] = std::move(value);
+                break;
+            }
+            case Op::Add: {
+                auto rhs = pop();
+                auto lhs = pop();
+                stack.push_back(ExecuteAdd(std::move(lhs), rhs, context));
+                break;
+            }
+            case Op::Sub: {
+                auto rhs = pop();
+                auto lhs = pop();
+                int rhs_value = 0;
+                int lhs_value = ExpectNumbers(lhs, rhs, rhs_value, "Wrong types for sub operation");
+                stack.push_back(runtime::ObjectHolder::Own(runtime::Number{lhs_value - rhs_value}));
+                break;
+            }
+            case Op::Mul: {
+                auto rhs = pop();
+                auto lhs = pop();
+                int rhs_value = 0;
+                int lhs_value = ExpectNumbers(lhs, rhs, rhs_value, "Wrong types for mult operation");
+                stack.push_back(runtime::ObjectHolder::Own(runtime::Number{lhs_value * rhs_value}));
+                break;
+            }
+            case Op::Div: {
+                auto rhs = pop();
+                auto lhs = pop();
+                int rhs_value = 0;
+                int lhs_value = ExpectNumbers(lhs, rhs, rhs_value, "Wrong types for div operation");
+                if (rhs_value == 0) {
+                    throw std::runtime_error("Division by zero");
+                }
+                stack.push_back(runtime::ObjectHolder::Own(runtime::Number{lhs_value / rhs_value}));
+                break;
+            }
+            case Op::Or: {
+                auto rhs = pop();
+                auto lhs = pop();
+                stack.push_back(runtime::ObjectHolder::Own(
+                    runtime::Bool{runtime::IsTrue(lhs) || runtime::IsTrue(rhs)}));
+                break;
+            }
+            case Op::And: {
+                auto rhs = pop();
+                auto lhs = pop();
+                stack.push_back(runtime::ObjectHolder::Own(
+                    runtime::Bool{runtime::IsTrue(lhs) && runtime::IsTrue(rhs)}));
+                break;
+            }
+            case Op::Not:
+                stack.push_back(runtime::ObjectHolder::Own(runtime::Bool{!runtime::IsTrue(pop())}));
+                break;
+            case Op::Str:
+                stack.push_back(runtime::ToString(pop(), context));
+                break;
+            case Op::PrintSep:
+                context.GetOutputStream() << " "s;
+                break;
+            case Op::PrintValue:
+                runtime::PrintValue(pop(), context);
+                break;
+            case Op::PrintNewline:
+                context.GetOutputStream() << std::endl;
+                break;
+            case Op::Call: {
+                // Аргументы передаются прямо из стека операндов, без временного вектора:
+                // выполнение тела метода этот стек не трогает
+                const size_t argc = instruction.arg2;
+                const runtime::ObjectHolder* args = stack.data() + (stack.size() - argc);
+                auto object = stack[stack.size() - argc - 1];
+                auto* instance = object.TryAs<runtime::ClassInstance>();
+                if (instance == nullptr) {
+                    throw std::runtime_error("Cannot call a method of a non-object value"s);
+                }
+                auto& site = chunk_.call_sites[instruction.arg];
+                const auto* cls = &instance->GetClass();
+                const auto* method = site.cache.Lookup(cls);
+                if (method == nullptr) {
+                    method = cls->GetMethod(site.method);
+                    if (method == nullptr || method->formal_params.size() != argc) {
+                        throw std::runtime_error("Not implemented"s);
+                    }
+                    site.cache.Insert(cls, method);
+                }
+                auto result = instance->CallMethod(method, args, argc, context);
+                stack.resize(stack.size() - argc - 1);
+                stack.push_back(std::move(result));
+                break;
+            }
+            case Op::Return:
+                // Результат return передаётся через исключение, как в ast::Return::Execute,
+                // и перехватывается в ast::MethodBody::Execute
+                throw pop();
+            case Op::Jump:
+                ip = instruction.arg;
+                break;
+            case Op::JumpIfFalse:
+                if (!runtime::IsTrue(pop())) {
+                    ip = instruction.arg;
+                }
+                break;
+            case Op::Pop:
+                pop();
+                break;
+            case Op::Execute:
+                stack.push_back(chunk_.statements[instruction.arg]->Execute(closure, context));
+                break;
+        }
+    }
+
+    return runtime::ObjectHolder::None();
+}
+
+std::unique_ptr<Program> Compile(std::unique_ptr<runtime::Executable> program) {
+    Chunk chunk = Compiler{}.Compile(*program);
+    return std::make_unique<Program>(std::move(chunk), std::move(program));
+}
+
+}  // namespace vm
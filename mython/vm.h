@@ -0,0 +1,97 @@
+#pragma once
+
+#include "runtime.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace vm {
+
+// Код операции виртуальной машины
+enum class Op : std::uint8_t {
+    Const,         // положить константу constants[arg] на стек
+    None,          // положить None на стек
+    LoadName,      // положить значение переменной names[arg] на стек
+    LoadChain,     // положить значение цепочки полей chains[arg] (id1.id2.id3) на стек
+    StoreName,     // снять значение со стека и записать его в переменную names[arg]
+    StoreField,    // снять значение и объект со стека, записать значение в поле names[arg] объекта
+    Add,           // снять два значения со стека, положить их сумму
+    Sub,           // снять два значения со стека, положить их разность
+    Mul,           // снять два значения со стека, положить их произведение
+    Div,           // снять два значения со стека, положить их частное
+    Or,            // снять два значения со стека, положить результат операции or
+    And,           // снять два значения со стека, положить результат операции and
+    Not,           // снять значение со стека, положить результат операции not
+    Str,           // снять значение со стека, положить его строковое представление
+    PrintSep,      // вывести пробел-разделитель команды print
+    PrintValue,    // снять значение со стека и вывести его
+    PrintNewline,  // завершить вывод команды print переводом строки
+    Call,          // вызвать метод call_sites[arg], сняв со стека arg2 аргументов и объект
+    Return,        // снять значение со стека и завершить выполнение текущего метода
+    Jump,          // перейти к инструкции arg
+    JumpIfFalse,   // снять значение со стека; если оно ложно, перейти к инструкции arg
+    Pop,           // снять значение со стека и отбросить его
+    Execute,       // выполнить statements[arg] как runtime::Executable и положить результат
+                   // на стек (запасной путь для узлов, не транслируемых в байт-код)
+};
+
+// Инструкция виртуальной машины: код операции и до двух целочисленных операндов.
+// Смысл операндов зависит от операции (см. комментарии к Op)
+struct Instruction {
+    Op op;
+    std::uint32_t arg = 0;
+    std::uint32_t arg2 = 0;
+};
+
+// Точка вызова метода. Помимо имени метода хранит инлайн-кэш разрешённых
+// методов: класс объекта в конкретной точке вызова почти никогда не меняется,
+// поэтому поиск по имени выполняется один раз на класс. Кэш безопасен при
+// одновременном выполнении программы из нескольких потоков
+struct CallSite {
+    runtime::Symbol method;
+    runtime::MethodCache cache;
+};
+
+// Скомпилированное тело программы: плоский массив инструкций и пулы операндов
+struct Chunk {
+    std::vector<Instruction> instructions;
+    // Константы программы (числа, строки, логические значения)
+    std::vector<runtime::ObjectHolder> constants;
+    // Имена переменных, полей и методов
+    std::vector<runtime::Symbol> names;
+    // Цепочки имён id1.id2.id3 для операции LoadChain
+    std::vector<std::vector<runtime::Symbol>> chains;
+    // Точки вызова методов для операции Call
+    std::vector<CallSite> call_sites;
+    // Узлы АСТ, исполняемые операцией Execute. Указатели не владеющие:
+    // узлы принадлежат дереву, сохранённому в Program
+    std::vector<runtime::Executable*> statements;
+};
+
+// Скомпилированная программа. Выполняется одним циклом диспетчеризации
+// без виртуальных вызовов на каждый узел АСТ
+class Program : public runtime::Executable {
+public:
+    Program(Chunk chunk, std::unique_ptr<runtime::Executable> source);
+
+    // Выполняет инструкции программы над closure, используя context
+    runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+
+    // Возвращает тело программы
+    [[nodiscard]] const Chunk& GetChunk() const;
+
+private:
+    Chunk chunk_;
+    // Исходное дерево программы. Хранится, поскольку операция Execute
+    // ссылается на его узлы
+    std::unique_ptr<runtime::Executable> source_;
+};
+
+// Транслирует дерево инструкций, построенное ParseProgram, в байт-код.
+// Узлы, для которых трансляция не реализована, выполняются напрямую
+// через операцию Execute
+std::unique_ptr<Program> Compile(std::unique_ptr<runtime::Executable> program);
+
+}  // namespace vm
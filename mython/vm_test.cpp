@@ -0,0 +1,121 @@
+#include "lexer.h"
+#include "parse.h"
+#include "test_runner_p.h"
+#include "vm.h"
+
+using namespace std;
+
+namespace vm {
+
+namespace {
+
+// Компилирует программу в байт-код и возвращает результат её выполнения
+string RunCompiledProgram(const string& program) {
+    istringstream is(program);
+    parse::Lexer lexer(is);
+    auto compiled = Compile(ParseProgram(lexer));
+
+    runtime::DummyContext context;
+    runtime::Closure closure;
+    compiled->Execute(closure, context);
+
+    return context.output.str();
+}
+
+}  // namespace
+
+void TestCompiledArithmetics() {
+    ASSERT_EQUAL(RunCompiledProgram("print 1+2+3+4+5, 1*2*3*4*5, 1-2-3-4-5, 36/4/3, 2*5+10/2"s),
+                 "15 120 -13 3 15\n"s);
+}
+
+void TestCompiledAssignmentsAndStrings() {
+    const string program = R"(
+x = 4
+y = 5
+z = "hello, "
+n = "world"
+print x + y, z + n, str(x), not x, x > y or y > x
+)"s;
+
+    ASSERT_EQUAL(RunCompiledProgram(program), "9 hello, world 4 False True\n"s);
+}
+
+void TestCompiledCondition() {
+    const string program = R"(
+x = 9
+if x > 10:
+  print 'big'
+else:
+  print 'small'
+if x < 10:
+  print 'checked'
+)"s;
+
+    ASSERT_EQUAL(RunCompiledProgram(program), "small\nchecked\n"s);
+}
+
+void TestCompiledClasses() {
+    const string program = R"(
+class Counter:
+  def __init__():
+    self.value = 0
+
+  def add():
+    self.value = self.value + 1
+    return self.value
+
+x = Counter()
+x.add()
+print x.add()
+print x.value
+)"s;
+
+    ASSERT_EQUAL(RunCompiledProgram(program), "2\n2\n"s);
+}
+
+void TestChunkIsFlat() {
+    const string program = R"(
+x = 1
+y = x + 2
+print y
+)"s;
+
+    istringstream is(program);
+    parse::Lexer lexer(is);
+    auto compiled = Compile(ParseProgram(lexer));
+    const Chunk& chunk = compiled->GetChunk();
+
+    ASSERT(!chunk.instructions.empty());
+    // Простая программа транслируется в байт-код целиком, без запасного пути
+    for (const auto& instruction : chunk.instructions) {
+        ASSERT(instruction.op != Op::Execute);
+    }
+}
+
+void TestConstantsAreShared() {
+    const string program = R"(
+x = 1
+y = 1
+print True, True, 1, 'hi', 'hi'
+)"s;
+
+    istringstream is(program);
+    parse::Lexer lexer(is);
+    auto compiled = Compile(ParseProgram(lexer));
+    const Chunk& chunk = compiled->GetChunk();
+
+    // Одинаковые константы (1, True, 'hi') хранятся в пуле в одном экземпляре
+    ASSERT_EQUAL(chunk.constants.size(), 3U);
+}
+
+void RunVMTests(TestRunner& tr) {
+    RUN_TEST(tr, vm::TestCompiledArithmetics);
+    RUN_TEST(tr, vm::TestCompiledAssignmentsAndStrings);
+    RUN_TEST(tr, vm::TestCompiledCondition);
+    RUN_TEST(tr, vm::TestCompiledClasses);
+    RUN_TEST(tr, vm::TestChunkIsFlat);
+    RUN_TEST(tr, vm::TestConstantsAreShared);
+}
+
+}  // namespace vm